@@ -0,0 +1,155 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "annotate.h"
+
+// Order results from the best for the side to move to the worst: quicker wins, then draws, then slower losses
+static inline int Annotate_score(const Result _R)
+{
+    return (_R.wdl == WIN_CHAR) ? MAKE7_AREA + 1 - _R.dt7 : (_R.wdl == LOSS_CHAR) ? _R.dt7 - MAKE7_AREA - 1 : 0;
+}
+
+// Write a result as it is shown after a solve, without colors; the end of the game has none
+static inline void Annotate_text(char* restrict _text, const size_t _SIZE, const Result _R)
+{
+    if ((_R.wdl == WIN_CHAR) || (_R.wdl == LOSS_CHAR))
+    {
+        snprintf(_text, _SIZE, "%c%d", _R.wdl, _R.dt7);
+    }
+    else
+    {
+        snprintf(_text, _SIZE, "%c", (_R.wdl == DRAW_CHAR) ? DRAW_CHAR : '-');
+    }
+}
+
+bool Annotate_game(Annotation* restrict _an, const char* restrict _SEQ, const bool _VERBOSE)
+{
+    NegamaxThread *nt = _an->thread;
+    AnnotatePly *ply;
+    Make7 m7[MAKE7_AREA + 1];
+    uint8_t moves[MAKE7_AREA], line[MAKE7_AREA];
+    int k, length, outcome, played;
+    
+    Make7_initialize(&m7[0]);
+    
+    if ((_an->count = Make7_moves(&m7[0], _SEQ, moves)) < 0)
+    {
+        return false;
+    }
+    
+    // Replay the game to keep every position along it
+    Make7_initialize(&m7[0]);
+    
+    for (k = 0; k < _an->count; k++)
+    {
+        m7[k + 1] = m7[k];
+        Make7_drop(&m7[k + 1], moves[k] >> 4, moves[k] & 0xf);
+    }
+    
+    // From the last position back, so each search finds the positions after it already proven in the table
+    for (k = _an->count; k >= 0; k--)
+    {
+        ply = &_an->ply[k];
+        *ply = (AnnotatePly) {.result = RESULT_UNKNOWN, .played = RESULT_UNKNOWN, .move = (k < _an->count) ? moves[k] : 0};
+        
+        // A game that ended with a 7 has no result left for the side to move; one that ended otherwise is drawn
+        if (Make7_tilesSumTo7(&m7[k]))
+        {
+            continue;
+        }
+        
+        if (Make7_noMoreMoves(&m7[k]) || Make7_gridFull(&m7[k]))
+        {
+            ply->result = RESULT_DRAW;
+            continue;
+        }
+        
+        if (_VERBOSE)
+        {
+            fprintf(stderr, "Solving ply %d of %d\n", k + 1, _an->count + 1);
+        }
+        
+        Negamax_resetNodes(nt->ctx);
+        
+        if (!Book_probe(_an->book, &m7[k], &ply->best, &ply->result) || (ply->result.wdl == UNKNOWN_CHAR))
+        {
+            if (!(_an->database && Database_load(_an->database, &m7[k], &ply->result)))
+            {
+                ply->result = Negamax_solve(nt, &m7[k], false);
+            }
+            
+            length = Negamax_principalVariation(nt, &m7[k], ply->result, line);
+            ply->best = length ? line[0] : (ply->result.wdl == DRAW_CHAR) ? Negamax_drawingMove(nt, &m7[k]) : 0;
+            
+            if (_an->database)
+            {
+                Database_storeLine(_an->database, &m7[k], ply->result, line, length);
+            }
+        }
+        
+        ply->nodes = Negamax_nodes(nt->ctx);
+    }
+    
+    _an->blunders = _an->inaccuracies = 0;
+    
+    // A move that makes 7 wins at once; any other is worth what the position it leads to is worth to the opponent
+    for (k = 0; k < _an->count; k++)
+    {
+        ply = &_an->ply[k];
+        
+        if (Make7_tilesSumTo7(&m7[k + 1]))
+        {
+            ply->played = (Result) { WIN_CHAR, 0 };
+        }
+        else
+        {
+            ply->played = _an->ply[k + 1].result;
+            Result_increment(&ply->played);
+        }
+        
+        outcome = Annotate_score(ply->result);
+        played = Annotate_score(ply->played);
+        
+        if ((ply->result.wdl == UNKNOWN_CHAR) || (ply->played.wdl == UNKNOWN_CHAR))
+        {
+            continue;
+        }
+        
+        if (((played > 0) - (played < 0)) < ((outcome > 0) - (outcome < 0)))
+        {
+            ply->mark = AN_BLUNDER;
+            _an->blunders++;
+        }
+        else if (played < outcome)
+        {
+            ply->mark = AN_INACCURACY;
+            _an->inaccuracies++;
+        }
+    }
+    
+    return true;
+}
+
+void Annotate_print(const Annotation* restrict _AN, FILE* restrict _out)
+{
+    const AnnotatePly *ply;
+    char value[8], played[8], move[8], best[8];
+    int k;
+    
+    fputs("Ply Move Value Played Best Nodes\n", _out);
+    
+    for (k = 0; k <= _AN->count; k++)
+    {
+        ply = &_AN->ply[k];
+        Annotate_text(value, sizeof(value), ply->result);
+        Annotate_text(played, sizeof(played), ply->played);
+        snprintf(move, sizeof(move), "%d%c", ply->move >> 4, 'A' + (ply->move & 0xf));
+        snprintf(best, sizeof(best), "%d%c", ply->best >> 4, 'A' + (ply->best & 0xf));
+        
+        // The last position has no move played from it
+        fprintf(_out, "%3d %4s %5s %6s %4s %llu %s\n", k + 1, ply->move ? move : "-", value, played, ply->best ? best : "-", ply->nodes, (ply->mark == AN_BLUNDER) ? "??" : (ply->mark == AN_INACCURACY) ? "?" : "");
+    }
+    
+    fprintf(_out, "%d blunder%s, %d inaccurac%s\n", _AN->blunders, (_AN->blunders == 1) ? "" : "s", _AN->inaccuracies, (_AN->inaccuracies == 1) ? "y" : "ies");
+}
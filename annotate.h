@@ -0,0 +1,60 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    Annotation solves every position of one game and marks the moves that threw away some of what the player had.
+    The positions are solved from the last ply back to the first, all over the same transposition table, which is never cleared in between.
+    Each position's search then finds the positions after it along the game already proven in the table, instead of searching their subtrees again.
+    
+    The value of a move played is that of the position it led to, seen by the player who made it; it is compared with the value of the position before it.
+    A move that turns a win into a draw or a loss, or a draw into a loss, is a blunder, marked "??".
+    One that keeps the outcome but wins more slowly or loses more quickly is an inaccuracy, marked "?".
+*/
+
+#ifndef ANNOTATE_H
+#define ANNOTATE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "make7.h"
+#include "result.h"
+#include "negamax.h"
+#include "book.h"
+#include "database.h"
+
+// Marks of a move played
+enum AnnotateMark
+{
+    AN_NONE, AN_INACCURACY, AN_BLUNDER
+};
+
+// A position of the game and the move played from it
+typedef struct
+{
+    Result result;                                                      // The result for the side to move
+    Result played;                                                      // The result of the move played, for the same side
+    uint8_t move;                                                       // The move played; zero after the last one
+    uint8_t best;                                                       // A best move, or zero if there is none
+    enum AnnotateMark mark;
+    unsigned long long nodes;                                           // Nodes it took
+}
+AnnotatePly;
+
+// Everything a game is annotated with
+typedef struct
+{
+    NegamaxThread *thread;                                              // The thread that solves, and its context with the table kept between plies
+    const Book *book;                                                   // Positions answered without searching
+    Database *database;                                                 // Positions solved before, and where new solves are kept; may be null
+    AnnotatePly ply[MAKE7_AREA + 1];                                    // Every position of the game, from the first
+    int count;                                                          // The number of moves played
+    int blunders, inaccuracies;
+}
+Annotation;
+
+// Annotating
+bool Annotate_game(Annotation*, const char*, const bool);                                               // Solve every position of a game from the last; false if it is not one
+void Annotate_print(const Annotation*, FILE*);                                                          // Write every ply with its values and marks, from the first
+
+#endif /* ANNOTATE_H */
@@ -0,0 +1,207 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "batch.h"
+
+// Write a result as it is shown after a solve, without colors
+static inline void Batch_writeResult(FILE* restrict _out, const Result _R)
+{
+    if ((_R.wdl == WIN_CHAR) || (_R.wdl == LOSS_CHAR))
+    {
+        fprintf(_out, "%c%d", _R.wdl, _R.dt7);
+    }
+    else
+    {
+        fputc(_R.wdl, _out);
+    }
+}
+
+void Batch_write(const Batch* restrict _BATCH, FILE* restrict _out, const BatchItem* restrict _ITEM)
+{
+    const BatchRecord *record = &_ITEM->record;
+    
+    switch (_BATCH->format)
+    {
+    case BATCH_BINARY:
+        fwrite(record, sizeof(*record), 1, _out);
+        break;
+    case BATCH_JSONL:
+        fprintf(_out, "{\"sequence\":\"%s\",\"result\":\"", _ITEM->text);
+        (record->status == BATCH_OK) ? Batch_writeResult(_out, record->result) : (void)(fputs((record->status == BATCH_OVER) ? "over" : "E", _out));
+        fputs("\",\"best\":", _out);
+        record->best ? fprintf(_out, "\"%d%c\"", record->best >> 4, 'A' + (record->best & 0xf)) : fputs("null", _out);
+        fprintf(_out, ",\"nodes\":%llu}\n", _ITEM->nodes);
+        break;
+    default:
+        fprintf(_out, "%s,", _ITEM->text);
+        (record->status == BATCH_OK) ? Batch_writeResult(_out, record->result) : (void)(fputs((record->status == BATCH_OVER) ? "over" : "E", _out));
+        fputc(',', _out);
+        
+        if (record->best)
+        {
+            fprintf(_out, "%d%c", record->best >> 4, 'A' + (record->best & 0xf));
+        }
+        
+        fprintf(_out, ",%llu\n", _ITEM->nodes);
+        break;
+    }
+}
+
+int Batch_worker(void *_args)
+{
+    BatchArgs *args = _args;
+    Batch *batch = args->batch;
+    TransTable *table = batch->tables ? &batch->tables[args->id] : &batch->ctx->table;
+    NegamaxThread worker;
+    BatchItem *item;
+    unsigned long long nodes;
+    size_t pos;
+    
+    // A table of its own is allocated by the thread that searches it, so it is first touched on that thread's node; it is kept for the next chunk
+    // Without one, the other tasks are told to stop and the batch ends once they have
+    if (!table->entry && !TransTable_initialize(table, batch->tableSize))
+    {
+        atomic_store(&batch->failed, true);
+        return 1;
+    }
+    
+    NegamaxThread_initialize(&worker, batch->ctx, table, 0);
+    
+    while (!atomic_load(&batch->failed) && ((pos = atomic_fetch_add(&batch->next, 1)) < batch->count))
+    {
+        item = &batch->item[pos];
+        item->length = 0;
+        nodes = atomic_load(worker.nodes);
+        
+        if (item->record.status != BATCH_OK)
+        {
+            continue;
+        }
+        
+        if (!Book_probe(batch->book, &item->m7, &item->record.best, &item->record.result) || (item->record.result.wdl == UNKNOWN_CHAR))
+        {
+            if (!(batch->database && Database_load(batch->database, &item->m7, &item->record.result)))
+            {
+                item->record.result = Negamax_solve(&worker, &item->m7, false);
+            }
+            
+            item->length = Negamax_principalVariation(&worker, &item->m7, item->record.result, item->line);
+            item->record.best = item->length ? item->line[0] : (item->record.result.wdl == DRAW_CHAR) ? Negamax_drawingMove(&worker, &item->m7) : 0;
+        }
+        
+        item->nodes = atomic_load(worker.nodes) - nodes;
+    }
+    
+    return 0;
+}
+
+bool Batch_run(Batch* restrict _batch, FILE* restrict _in, FILE* restrict _out, const bool _PRIVATE)
+{
+    ThreadPool *pool = _batch->ctx->pool;
+    BatchArgs args[pool->count];
+    BatchItem *item;
+    char text[MAKE7_AREA_X2 + 3], *end;
+    size_t pos;
+    int c, task, moves;
+    bool success, whole;
+    
+    _batch->tables = _PRIVATE ? calloc(pool->count, sizeof(*_batch->tables)) : nullptr;
+    _batch->tableSize = _batch->ctx->table.size / pool->count;
+    _batch->item = malloc(BATCH_CHUNK * sizeof(*_batch->item));
+    _batch->total = 0;
+    atomic_store(&_batch->failed, false);
+    success = _batch->item && (!_PRIVATE || _batch->tables);
+    
+    if (success && (_batch->format == BATCH_CSV))
+    {
+        fputs("sequence,result,best,nodes\n", _out);
+    }
+    
+    while (success)
+    {
+        // Read the next chunk; an empty line is the starting position, as on standard input
+        for (_batch->count = 0; (_batch->count < BATCH_CHUNK) && fgets(text, sizeof(text), _in); _batch->count++)
+        {
+            item = &_batch->item[_batch->count];
+            
+            // A line too long for any game is thrown away up to its end
+            if (!(whole = (strchr(text, '\n') || feof(_in))))
+            {
+                while (((c = getc(_in)) != EOF) && (c != '\n'));
+            }
+            
+            for (end = text + strlen(text); (end > text) && ((end[-1] == '\n') || (end[-1] == '\r') || (end[-1] == ' ') || (end[-1] == '\t')); *--end = '\0');
+            
+            // Echoed as it was read, except for anything that would break a CSV field or a JSON string
+            snprintf(item->text, sizeof(item->text), "%s", text);
+            
+            for (end = item->text; *end; end++)
+            {
+                *end = ((*end >= '0') && (*end <= '9')) || ((*end >= 'A') && (*end <= 'Z')) || ((*end >= 'a') && (*end <= 'z')) ? *end : '?';
+            }
+            
+            Make7_initialize(&item->m7);
+            item->record = (BatchRecord) {.status = BATCH_INVALID};
+            item->nodes = 0;
+            item->length = 0;
+            
+            if (whole && ((moves = Make7_moves(&item->m7, text, item->record.moves)) >= 0))
+            {
+                item->record.count = moves;
+                item->record.status = (Make7_gameOver(&item->m7) || Make7_gridFull(&item->m7)) ? BATCH_OVER : BATCH_OK;
+            }
+        }
+        
+        if (!_batch->count)
+        {
+            break;
+        }
+        
+        atomic_store(&_batch->next, 0);
+        
+        for (task = 0; task < pool->count; task++)
+        {
+            args[task] = (BatchArgs) {_batch, task};
+            ThreadPool_submit(pool, Batch_worker, &args[task]);
+        }
+        
+        ThreadPool_wait(pool);
+        
+        // The chunk may be half solved; nothing of it is written
+        if (atomic_load(&_batch->failed))
+        {
+            fprintf(stderr, "Could not initialize the transposition table of a batch task.\n");
+            success = false;
+            break;
+        }
+        
+        // Only this thread writes to the database, between chunks, so the workers can read it without locks
+        for (pos = 0; pos < _batch->count; pos++)
+        {
+            item = &_batch->item[pos];
+            
+            if (_batch->database && (item->record.status == BATCH_OK))
+            {
+                Database_storeLine(_batch->database, &item->m7, item->record.result, item->line, item->length);
+            }
+            
+            Batch_write(_batch, _out, item);
+        }
+        
+        _batch->total += _batch->count;
+        success = !fflush(_out) && !ferror(_out);
+    }
+    
+    for (task = 0; _batch->tables && (task < pool->count); task++)
+    {
+        TransTable_destroy(&_batch->tables[task]);
+    }
+    
+    free(_batch->tables);
+    free(_batch->item);
+    _batch->tables = nullptr;
+    _batch->item = nullptr;
+    
+    return success && !ferror(_in);
+}
@@ -0,0 +1,101 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    Batch mode labels a file of positions with their results and best moves, for data sets far too large to feed through the solving loop one at a time.
+    Each line holds a move sequence; the file is read in chunks, so it streams through in constant memory however long it is.
+    The positions of a chunk are dealt out to one task per pool worker, each taking the next unsolved one as soon as it is done with the last.
+    
+    The workers search one shared table by default, like the tablebase generator, so what one proves the others reuse; with -p each gets its own.
+    The tables are never cleared between positions, since they only ever hold proven results.
+    Results are written in the order the positions were read, as CSV, JSON Lines or fixed-size binary records, without drawing any grid.
+    A line that is not a move sequence is reported as an error in its place, and a game already over as such, so that the output always lines up with the input.
+*/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "make7.h"
+#include "table.h"
+#include "result.h"
+#include "pool.h"
+#include "negamax.h"
+#include "book.h"
+#include "database.h"
+
+// Positions read and solved at a time
+#define BATCH_CHUNK 4096
+
+// Output formats
+enum BatchFormat
+{
+    BATCH_CSV, BATCH_JSONL, BATCH_BINARY
+};
+
+// Status of a position
+enum BatchStatus
+{
+    BATCH_OK, BATCH_INVALID, BATCH_OVER
+};
+
+// The binary output of a position; every member is a single byte, so there is no padding or byte order
+typedef struct
+{
+    uint8_t status;                                                     // One of the codes above; only the moves are set unless it is BATCH_OK
+    uint8_t best;                                                       // The best move, tile in the upper four bits and column in the lower four; zero if none
+    Result result;                                                      // The result for the side to move
+    uint8_t count;                                                      // The number of moves to the position
+    uint8_t moves[MAKE7_AREA];                                          // The moves themselves, encoded like the best move
+}
+BatchRecord;
+
+// A position being solved
+typedef struct
+{
+    char text[MAKE7_AREA_X2 + 1];                                       // The line it was read from, as far as it fits
+    BatchRecord record;                                                 // Its answer, and the moves leading to it
+    Make7 m7;
+    uint8_t line[MAKE7_AREA];                                           // Its principal variation, kept for the database
+    int length;
+    unsigned long long nodes;                                           // Nodes it took
+}
+BatchItem;
+
+// Everything a batch runs with
+typedef struct Batch
+{
+    NegamaxContext *ctx;                                                // The solver, its pool, and the table shared by the workers
+    const Book *book;                                                   // Positions answered without searching
+    Database *database;                                                 // Positions solved before, and where new solves are kept; may be null
+    TransTable *tables;                                                 // One table per task, or null to share the context's
+    size_t tableSize;                                                   // Entries in each of those
+    BatchItem *item;                                                    // The chunk being solved
+    size_t count;                                                       // Its number of positions
+    atomic_size_t next;                                                 // The next position to solve
+    atomic_bool failed;                                                 // A task could not allocate its table
+    size_t total;                                                       // Positions written so far
+    enum BatchFormat format;
+}
+Batch;
+
+// A task's parameters
+typedef struct
+{
+    Batch *batch;
+    int id;
+}
+BatchArgs;
+
+// Writing
+void Batch_write(const Batch*, FILE*, const BatchItem*);                                                // Write a position's answer in the batch's format
+
+// Solving
+int Batch_worker(void*);                                                                                // Solve positions of the chunk until none are left
+bool Batch_run(Batch*, FILE*, FILE*, const bool);                                                       // Solve every position of a file and write the answers
+
+#endif /* BATCH_H */
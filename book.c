@@ -0,0 +1,190 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "book.h"
+
+void Book_destroy(Book* restrict _book)
+{
+    free(_book->key);
+    free(_book->move);
+    free(_book->value);
+    _book->key = nullptr;
+    _book->move = _book->value = nullptr;
+    _book->count = 0;
+}
+
+bool Book_save(const Book* restrict _BOOK, const char* restrict _PATH)
+{
+    FILE *file = fopen(_PATH, "wb");
+    uint32_t version = BOOK_VERSION;
+    uint64_t count = _BOOK->count;
+    bool written;
+    
+    if (!file)
+    {
+        return false;
+    }
+    
+    written = (fwrite(BOOK_MAGIC, 4, 1, file) == 1) && (fwrite(&version, sizeof(version), 1, file) == 1) && (fwrite(&count, sizeof(count), 1, file) == 1)
+        && (fwrite(_BOOK->key, sizeof(*_BOOK->key), _BOOK->count, file) == _BOOK->count) && (fwrite(_BOOK->move, 1, _BOOK->count, file) == _BOOK->count) && (fwrite(_BOOK->value, 1, _BOOK->count, file) == _BOOK->count);
+    
+    return !fclose(file) && written;
+}
+
+bool Book_load(Book* restrict _book, const char* restrict _PATH)
+{
+    FILE *file = fopen(_PATH, "rb");
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+    bool read;
+    
+    _book->key = nullptr;
+    _book->move = _book->value = nullptr;
+    _book->count = 0;
+    
+    if (!file)
+    {
+        return false;
+    }
+    
+    // Refuse files that are not books, or of another version
+    if ((fread(magic, 4, 1, file) != 1) || memcmp(magic, BOOK_MAGIC, 4) || (fread(&version, sizeof(version), 1, file) != 1) || (version != BOOK_VERSION) || (fread(&count, sizeof(count), 1, file) != 1))
+    {
+        fclose(file);
+        return false;
+    }
+    
+    if (!(_book->key = malloc(count * sizeof(*_book->key))) || !(_book->move = malloc(count)) || !(_book->value = malloc(count)))
+    {
+        fclose(file);
+        Book_destroy(_book);
+        return false;
+    }
+    
+    _book->count = count;
+    read = (fread(_book->key, sizeof(*_book->key), count, file) == count) && (fread(_book->move, 1, count, file) == count) && (fread(_book->value, 1, count, file) == count);
+    fclose(file);
+    
+    if (!read)
+    {
+        Book_destroy(_book);
+    }
+    
+    return read;
+}
+
+uint8_t Book_orient(const Make7* restrict _M7, const uint8_t _MOVE)
+{
+    TB_Key own = { Make7_hashEncode(_M7), _M7->tiles23[0], _M7->tiles23[1] }, key = Tablebase_key(_M7);
+    
+    // Keys of the mirror image mean the move is mirrored too; flipping twice gives the move back
+    return Tablebase_compare(&own, &key) ? (_MOVE & 0xf0) | (MAKE7_SIZE - 1 - (_MOVE & 0xf)) : _MOVE;
+}
+
+bool Book_probe(const Book* restrict _BOOK, const Make7* restrict _M7, uint8_t* restrict _move, Result* restrict _result)
+{
+    TB_Key key = Tablebase_key(_M7);
+    TB_Key *found = _BOOK->count ? bsearch(&key, _BOOK->key, _BOOK->count, sizeof(*_BOOK->key), Tablebase_compare) : nullptr;
+    
+    if (!found)
+    {
+        return false;
+    }
+    
+    *_move = Book_orient(_M7, _BOOK->move[found - _BOOK->key]);
+    *_result = Tablebase_decode(_BOOK->value[found - _BOOK->key]);
+    
+    return true;
+}
+
+bool Book_build(Book* restrict _book, NegamaxThread* restrict _nt, MCTSContext* restrict _mcts, const Make7* restrict _ROOT, const uint8_t _PLIES, const NegamaxLimits _LIMITS)
+{
+    TB_Position *layer = malloc(sizeof(*layer)), *next, *all = nullptr, *grown;
+    size_t count = 1, total = 0, kept = 0;
+    uint8_t pvLine[MAKE7_AREA], move;
+    Result result;
+    bool success = layer;
+    
+    _book->key = nullptr;
+    _book->move = _book->value = nullptr;
+    _book->count = 0;
+    
+    if (success)
+    {
+        layer->m7 = *_ROOT;
+        layer->key = Tablebase_key(_ROOT);
+    }
+    
+    // Gather every position before the last ply; the last one never needs a move from the book
+    for (uint8_t ply = 0; success && (ply < _PLIES); ply++)
+    {
+        if ((success = (grown = realloc(all, (total + count) * sizeof(*all)))))
+        {
+            all = grown;
+            memcpy(&all[total], layer, count * sizeof(*all));
+            total += count;
+        }
+        
+        if (success && (ply + 1 < _PLIES))
+        {
+            success = ((count = Tablebase_expand(layer, count, &next)) != SIZE_MAX);
+            free(layer);
+            layer = next;
+        }
+    }
+    
+    free(layer);
+    
+    // Every ply holds a different number of tiles, so no two positions share keys; those already over have no move to play
+    if (success)
+    {
+        qsort(all, total, sizeof(*all), Tablebase_compare);
+        
+        for (size_t pos = 0; pos < total; pos++)
+        {
+            if (!Make7_tilesSumTo7(&all[pos].m7) && !Make7_noMoreMoves(&all[pos].m7))
+            {
+                all[kept++] = all[pos];
+            }
+        }
+        
+        success = (_book->key = malloc(kept * sizeof(*_book->key) + 1)) && (_book->move = malloc(kept + 1)) && (_book->value = malloc(kept + 1));
+    }
+    
+    // Minimax where it proves a result within the budget, and Monte Carlo tree search where it does not
+    _mcts->seconds = BOOK_MCTS_FACTOR * (_LIMITS.seconds ? _LIMITS.seconds : 1.0);
+    
+    for (size_t pos = 0; success && (pos < kept); pos++)
+    {
+        Make7 m7 = all[pos].m7;
+        
+        if ((result = Negamax_solve_limited(_nt, &m7, _LIMITS, &move, false)).wdl == UNKNOWN_CHAR)
+        {
+            move = MCTS_search(_mcts, &m7, nullptr, false);
+        }
+        else
+        {
+            // A decisive result has a line to follow, whose first move is the shortest win or longest loss
+            move = Negamax_principalVariation(_nt, &m7, result, pvLine) ? pvLine[0] : move;
+        }
+        
+        _book->value[pos] = Tablebase_encode(result);
+        _book->key[pos] = all[pos].key;
+        _book->move[pos] = Book_orient(&m7, move);
+        _book->count = pos + 1;
+        printf("\r%llu/%llu %d%c ", (unsigned long long)(pos + 1), (unsigned long long)(kept), move >> 4, 'A' + (move & 0xf));
+        (result.wdl == UNKNOWN_CHAR) ? puts("?") : (Result_print(&result, &result), puts(""));
+    }
+    
+    _mcts->seconds = 0.0;
+    free(all);
+    
+    if (!success)
+    {
+        Book_destroy(_book);
+    }
+    
+    return success;
+}
@@ -0,0 +1,52 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    The opening book holds a move to play in every position of the first few plies of the game, so that neither engine has to think about the opening.
+    It is built by enumerating every position up to a number of plies, one of each pair of mirror images only, the same way the endgame tablebase is.
+    Each position is first solved by minimax within the budget given with -T or -N. When that proves nothing, Monte Carlo tree search picks the move instead over a longer run.
+    
+    The file holds the keys of every position in sorted order, then the move of each, then its result when proven; the rank of a position's keys is the index of both.
+    Moves are stored for whichever of the position and its mirror image the keys belong to, and flipped back when the book is probed.
+*/
+
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "make7.h"
+#include "result.h"
+#include "tablebase.h"
+#include "negamax.h"
+#include "mcts.h"
+
+#define BOOK_MAGIC "M7BK"
+#define BOOK_VERSION 1
+
+// How much longer Monte Carlo tree search runs on a position than the minimax budget
+#define BOOK_MCTS_FACTOR 4
+
+// The opening book itself
+typedef struct
+{
+    TB_Key *key;
+    uint8_t *move, *value;
+    size_t count;
+}
+Book;
+
+// Memory and I/O
+void Book_destroy(Book*);                                                                               // Release the memory allocated to it
+bool Book_save(const Book*, const char*);                                                               // Write it to a file
+bool Book_load(Book*, const char*);                                                                     // Read it from a file
+
+// Lookups
+uint8_t Book_orient(const Make7*, const uint8_t);                                                       // Flip a move between a position and the orientation its keys are stored in
+bool Book_probe(const Book*, const Make7*, uint8_t*, Result*);                                          // Look up the move and result of a position; false if not in it
+
+// Building
+bool Book_build(Book*, NegamaxThread*, MCTSContext*, const Make7*, const uint8_t, const NegamaxLimits); // Build the book of a root position to a number of plies
+
+#endif /* BOOK_H */
@@ -0,0 +1,188 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "checkpoint.h"
+
+// Ask the solve in progress to take a checkpoint and stop after receiving SIGTERM; without one, terminate as usual
+static inline void Checkpoint_terminate(int _SIGNAL)
+{
+    Checkpoint *ck = atomic_load(&checkpointActive);
+    
+    if (ck)
+    {
+        atomic_store(&ck->terminate, true);
+    }
+    else
+    {
+        signal(_SIGNAL, SIG_DFL);
+        raise(_SIGNAL);
+    }
+}
+
+// Read the monotonic clock in nanoseconds
+static inline unsigned long long Checkpoint_clock(void)
+{
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+void Checkpoint_initialize(Checkpoint* restrict _ck, const char* restrict _PATH, const double _MINUTES)
+{
+    _ck->path = _PATH;
+    _ck->interval = (unsigned long long)(_MINUTES * 60e9);
+    _ck->due = 0;
+    _ck->owner = nullptr;
+    _ck->r1 = _ck->r2 = _ck->r3 = nullptr;
+    _ck->restored = _ck->terminated = false;
+    memset(&_ck->saved, 0, sizeof(_ck->saved));
+    memset(&_ck->resumed, 0, sizeof(_ck->resumed));
+    atomic_init(&_ck->terminate, false);
+    atomic_store(&checkpointActive, nullptr);
+    signal(SIGTERM, Checkpoint_terminate);
+}
+
+bool Checkpoint_restore(Checkpoint* restrict _ck, TransTable* restrict _tt)
+{
+    FILE *file = fopen(_ck->path, "rb");
+    CheckpointHeader header;
+    TT_Entry *entry;
+    bool read;
+    
+    if (!file)
+    {
+        return false;
+    }
+    
+    // Refuse files that are not checkpoints, or of another version
+    if ((fread(&header, sizeof(header), 1, file) != 1) || memcmp(header.magic, CK_MAGIC, 4) || (header.version != CK_VERSION) || !header.size || fseek(file, CK_ALIGN, SEEK_SET) || !(entry = malloc(header.size * sizeof(*entry))))
+    {
+        fclose(file);
+        return false;
+    }
+    
+    Numa_interleave(entry, header.size * sizeof(*entry));
+    read = (fread(entry, sizeof(*entry), header.size, file) == header.size);
+    fclose(file);
+    
+    if (!read)
+    {
+        free(entry);
+        return false;
+    }
+    
+    // The saved size is kept as it is, since every entry's slot depends on it
+    TransTable_destroy(_tt);
+    _tt->entry = entry;
+    _tt->size = header.size;
+    _ck->resumed = header;
+    _ck->restored = true;
+    
+    return true;
+}
+
+bool Checkpoint_save(Checkpoint* restrict _ck, const TransTable* restrict _TT)
+{
+    char temporary[CK_PATH], padding[CK_ALIGN - sizeof(CheckpointHeader)] = { 0 };
+    FILE *file;
+    bool written;
+    
+    memcpy(_ck->saved.magic, CK_MAGIC, 4);
+    _ck->saved.version = CK_VERSION;
+    _ck->saved.size = _TT->size;
+    
+    // An analysis keeps the moves it has already settled
+    if (_ck->r1)
+    {
+        memcpy(_ck->saved.r1, _ck->r1, sizeof(_ck->saved.r1));
+        memcpy(_ck->saved.r2, _ck->r2, sizeof(_ck->saved.r2));
+        memcpy(_ck->saved.r3, _ck->r3, sizeof(_ck->saved.r3));
+    }
+    
+    snprintf(temporary, sizeof(temporary), "%s.tmp", _ck->path);
+    
+    if (!(file = fopen(temporary, "wb")))
+    {
+        return false;
+    }
+    
+    written = (fwrite(&_ck->saved, sizeof(_ck->saved), 1, file) == 1) && (fwrite(padding, sizeof(padding), 1, file) == 1) && (fwrite(_TT->entry, sizeof(*_TT->entry), _TT->size, file) == _TT->size) && !fflush(file);
+    
+#ifdef __unix__
+    written = written && !fsync(fileno(file));
+#endif
+    
+    return !fclose(file) && written && !rename(temporary, _ck->path);
+}
+
+int Checkpoint_begin(Checkpoint* restrict _ck, NegamaxThread* restrict _nt, const Make7* restrict _ROOT, const int _STAGE, Result* restrict _r1, Result* restrict _r2, Result* restrict _r3)
+{
+    int depth = 0;
+    
+    // A restored checkpoint is only resumed by the same stage of the same position; its table helps any other one all the same
+    if (_ck->restored && memcmp(&_ck->resumed.root, _ROOT, sizeof(*_ROOT)))
+    {
+        _ck->restored = false;
+    }
+    
+    if (_ck->restored && (_ck->resumed.stage == _STAGE))
+    {
+        depth = _ck->resumed.depth;
+        
+        if (_r1)
+        {
+            memcpy(_r1, _ck->resumed.r1, sizeof(_ck->resumed.r1));
+            memcpy(_r2, _ck->resumed.r2, sizeof(_ck->resumed.r2));
+            memcpy(_r3, _ck->resumed.r3, sizeof(_ck->resumed.r3));
+        }
+        
+        _ck->restored = false;
+    }
+    
+    _ck->saved.root = *_ROOT;
+    _ck->saved.stage = _STAGE;
+    _ck->owner = _nt;
+    _ck->r1 = _r1;
+    _ck->r2 = _r2;
+    _ck->r3 = _r3;
+    _ck->due = Checkpoint_clock() + _ck->interval;
+    atomic_store(&checkpointActive, _ck);
+    
+    return depth;
+}
+
+void Checkpoint_end(Checkpoint* restrict _ck)
+{
+    atomic_store(&checkpointActive, nullptr);
+    _ck->owner = nullptr;
+    _ck->r1 = _ck->r2 = _ck->r3 = nullptr;
+}
+
+void Checkpoint_poll(Checkpoint* restrict _ck, NegamaxThread* restrict _nt)
+{
+    bool terminate = atomic_load(&_ck->terminate);
+    
+    if ((_ck->owner != _nt) || _ck->terminated || (!terminate && (Checkpoint_clock() < _ck->due)))
+    {
+        return;
+    }
+    
+    // The iteration in progress is saved as not done yet, so resuming repeats it with the table's help; the checkpoint restored stays until it is resumed
+    _ck->saved.depth = _nt->rootDepth;
+    
+    if (!_ck->restored && !Checkpoint_save(_ck, _nt->table))
+    {
+        fprintf(stderr, "Could not write the checkpoint to \"%s\".\n", _ck->path);
+    }
+    
+    _ck->due = Checkpoint_clock() + _ck->interval;
+    
+    if (terminate)
+    {
+        _ck->terminated = true;
+        atomic_store(&_nt->ctx->stop, true);
+    }
+}
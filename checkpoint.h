@@ -0,0 +1,86 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    Checkpoints keep a long minimax solve alive across a killed process, so that it can be scheduled on machines that may be taken away at any time.
+    Every few minutes, and once more when SIGTERM arrives, the thread running the solve writes its transposition table to disk along with where it was.
+    That is the root position, the depth of the iteration in progress, and for the analysis of every move after the solve, the moves already settled.
+    
+    A checkpoint is taken from inside the search, between two nodes; the table then holds nothing but proven bounds, so any moment is as good as another.
+    Resuming starts the solve again at the saved iteration with the saved table; the iterations before it had ended without a proof, so none need repeating.
+    The file is written under another name and renamed over the last one, so a process killed while writing always leaves the previous checkpoint intact.
+    The table starts at a page boundary, so the file can be mapped into memory as it is.
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "make7.h"
+#include "table.h"
+#include "result.h"
+#include "negamax.h"
+#include "numa.h"
+
+#define CK_MAGIC "M7CK"
+#define CK_VERSION 1
+
+// The table starts this far into the file
+#define CK_ALIGN 4096
+
+// Minutes between checkpoints when none are given
+#define CK_INTERVAL 10
+
+// Length of the path the checkpoint is written to before it is renamed
+#define CK_PATH 4096
+
+// The stage of a solve a checkpoint was taken in
+enum CheckpointStage
+{
+    CK_SOLVE, CK_ANALYZE
+};
+
+// The start of the file
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    Make7 root;
+    int32_t stage, depth;
+    Result r1[MAKE7_SIZE], r2[MAKE7_SIZE], r3[MAKE7_SIZE];
+    uint64_t size;
+}
+CheckpointHeader;
+
+// Everything needed to take and resume checkpoints
+typedef struct Checkpoint
+{
+    const char *path;                                                   // The file the checkpoints are written to
+    unsigned long long interval, due;                                   // Nanoseconds between checkpoints, and the monotonic time the next one is due
+    NegamaxThread *owner;                                               // The thread of the solve in progress; only it takes checkpoints
+    Result *r1, *r2, *r3;                                               // The results of every root move while they are being analyzed
+    CheckpointHeader saved, resumed;                                    // Where the solve was at the last checkpoint taken, and at the one restored
+    atomic_bool terminate;                                              // SIGTERM arrived; take a checkpoint at once and stop
+    bool restored, terminated;                                          // The restored checkpoint is yet to be resumed; the solve was stopped by SIGTERM
+}
+Checkpoint;
+
+// The checkpoint of the solve in progress; a signal handler cannot be handed one of its own
+static _Atomic(Checkpoint*) checkpointActive;
+
+// Setting up
+void Checkpoint_initialize(Checkpoint*, const char*, const double);                                     // Take checkpoints to a file every number of minutes
+bool Checkpoint_restore(Checkpoint*, TransTable*);                                                      // Read the last checkpoint back, replacing the table
+
+// Taking checkpoints
+bool Checkpoint_save(Checkpoint*, const TransTable*);                                                   // Write the table and where the solve is to the file
+int Checkpoint_begin(Checkpoint*, NegamaxThread*, const Make7*, const int, Result*, Result*, Result*);  // Start taking checkpoints of a stage; the depth to start at
+void Checkpoint_end(Checkpoint*);                                                                       // Stop taking them once the stage is over
+void Checkpoint_poll(Checkpoint*, NegamaxThread*);                                                      // Take one if it is due or SIGTERM arrived
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,297 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "database.h"
+
+// The number of bytes in a file of a given capacity
+static inline size_t Database_bytes(const uint64_t _CAPACITY)
+{
+    return sizeof(DB_Header) + _CAPACITY * sizeof(DB_Entry);
+}
+
+bool Database_map(Database* restrict _db, const uint64_t _CAPACITY)
+{
+    size_t oldBytes = _db->header ? Database_bytes(_db->header->capacity) : 0, newBytes = Database_bytes(_CAPACITY);
+    void *map;
+    
+#ifdef __unix__
+    // The file grows with zeros, which read as empty entries
+    if (_db->header)
+    {
+        munmap(_db->header, oldBytes);
+        _db->header = nullptr;
+        _db->entry = nullptr;
+    }
+    
+    if (ftruncate(_db->fd, newBytes) || ((map = mmap(nullptr, newBytes, PROT_READ | PROT_WRITE, MAP_SHARED, _db->fd, 0)) == MAP_FAILED))
+    {
+        return false;
+    }
+#else
+    // Without mmap, the file is kept in memory and written back when closed
+    if (!(map = realloc(_db->header, newBytes)))
+    {
+        return false;
+    }
+    
+    if (newBytes > oldBytes)
+    {
+        memset((char*)(map) + oldBytes, 0, newBytes - oldBytes);
+    }
+#endif
+    
+    _db->header = map;
+    _db->entry = (DB_Entry*)(_db->header + 1);
+    
+    return true;
+}
+
+bool Database_open(Database* restrict _db, const char* restrict _PATH)
+{
+    DB_Header header;
+    uint64_t fileBytes;
+    bool valid;
+    
+    _db->header = nullptr;
+    _db->entry = nullptr;
+    _db->path = _PATH;
+    _db->fd = -1;
+    
+#ifdef __unix__
+    struct stat status;
+    
+    if (((_db->fd = open(_PATH, O_RDWR | O_CREAT, 0644)) < 0) || fstat(_db->fd, &status))
+    {
+        Database_close(_db);
+        return false;
+    }
+    
+    fileBytes = status.st_size;
+    valid = fileBytes && (pread(_db->fd, &header, sizeof(header), 0) == sizeof(header));
+#else
+    FILE *file = fopen(_PATH, "rb");
+    
+    fileBytes = 0;
+    valid = file && (fread(&header, sizeof(header), 1, file) == 1);
+    
+    if (file)
+    {
+        fseek(file, 0, SEEK_END);
+        fileBytes = ftell(file);
+    }
+#endif
+    
+    // Start a new database in an empty file
+    if (!fileBytes)
+    {
+#ifndef __unix__
+        if (file)
+        {
+            fclose(file);
+        }
+#endif
+        
+        if (!Database_map(_db, DB_CAPACITY))
+        {
+            Database_close(_db);
+            return false;
+        }
+        
+        memcpy(_db->header->magic, DB_MAGIC, 4);
+        _db->header->version = DB_VERSION;
+        _db->header->capacity = DB_CAPACITY;
+        _db->header->count = 0;
+        
+        return true;
+    }
+    
+    // Refuse files that are not databases, of another version, or cut short
+    valid = valid && !memcmp(header.magic, DB_MAGIC, 4) && (header.version == DB_VERSION) && header.capacity && !(header.capacity & (header.capacity - 1)) && (fileBytes == Database_bytes(header.capacity));
+    
+#ifdef __unix__
+    if (!valid || !Database_map(_db, header.capacity))
+    {
+        Database_close(_db);
+        return false;
+    }
+#else
+    if (!valid || !(_db->header = malloc(fileBytes)))
+    {
+        if (file)
+        {
+            fclose(file);
+        }
+        
+        Database_close(_db);
+        return false;
+    }
+    
+    rewind(file);
+    valid = (fread(_db->header, fileBytes, 1, file) == 1);
+    _db->entry = (DB_Entry*)(_db->header + 1);
+    fclose(file);
+    
+    if (!valid)
+    {
+        Database_close(_db);
+        return false;
+    }
+#endif
+    
+    return true;
+}
+
+void Database_close(Database* restrict _db)
+{
+#ifdef __unix__
+    if (_db->header)
+    {
+        munmap(_db->header, Database_bytes(_db->header->capacity));
+    }
+    
+    if (_db->fd >= 0)
+    {
+        close(_db->fd);
+    }
+#else
+    FILE *file;
+    
+    if (_db->header && (file = fopen(_db->path, "wb")))
+    {
+        if (fwrite(_db->header, Database_bytes(_db->header->capacity), 1, file) != 1)
+        {
+            fprintf(stderr, "Could not write the database back to \"%s\".\n", _db->path);
+        }
+        
+        fclose(file);
+    }
+    
+    free(_db->header);
+#endif
+    
+    _db->header = nullptr;
+    _db->entry = nullptr;
+    _db->fd = -1;
+}
+
+size_t Database_index(const TB_Key* restrict _KEY, const uint64_t _CAPACITY)
+{
+    return (_KEY->gridKey ^ (_KEY->twoKey * 0x9e3779b97f4a7c15ull) ^ (_KEY->threeKey * 0xc2b2ae3d27d4eb4full)) & (_CAPACITY - 1);
+}
+
+bool Database_load(const Database* restrict _DB, const Make7* restrict _M7, Result* restrict _result)
+{
+    if (!_DB->header->count)
+    {
+        return false;
+    }
+    
+    TB_Key key = Tablebase_key(_M7);
+    uint64_t mask = _DB->header->capacity - 1;
+    
+    // The table is never full, so an empty slot always ends the probe
+    for (size_t i = Database_index(&key, _DB->header->capacity); _DB->entry[i].value; i = (i + 1) & mask)
+    {
+        if (!Tablebase_compare(&_DB->entry[i].key, &key))
+        {
+            *_result = Tablebase_decode(_DB->entry[i].value & ~DB_USED);
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool Database_insert(Database* restrict _db, const TB_Key* restrict _KEY, const uint64_t _VALUE)
+{
+    uint64_t mask = _db->header->capacity - 1;
+    size_t i;
+    
+    for (i = Database_index(_KEY, _db->header->capacity); _db->entry[i].value; i = (i + 1) & mask)
+    {
+        if (!Tablebase_compare(&_db->entry[i].key, _KEY))
+        {
+            _db->entry[i].value = _VALUE;
+            return false;
+        }
+    }
+    
+    _db->entry[i].key = *_KEY;
+    _db->entry[i].value = _VALUE;
+    
+    return true;
+}
+
+bool Database_grow(Database* restrict _db)
+{
+    uint64_t capacity = _db->header->capacity, count = 0;
+    DB_Entry *old = malloc(_db->header->count * sizeof(*old));
+    
+    if (!old)
+    {
+        return false;
+    }
+    
+    // Set the entries aside, since the new capacity moves all of their slots
+    for (uint64_t i = 0; i < capacity; i++)
+    {
+        if (_db->entry[i].value)
+        {
+            old[count++] = _db->entry[i];
+        }
+    }
+    
+    if (!Database_map(_db, capacity << 1))
+    {
+        free(old);
+        return false;
+    }
+    
+    _db->header->capacity = capacity << 1;
+    memset(_db->entry, 0, _db->header->capacity * sizeof(*_db->entry));
+    
+    for (uint64_t i = 0; i < count; i++)
+    {
+        Database_insert(_db, &old[i].key, old[i].value);
+    }
+    
+    free(old);
+    
+    return true;
+}
+
+bool Database_store(Database* restrict _db, const Make7* restrict _M7, const Result _RESULT)
+{
+    TB_Key key = Tablebase_key(_M7);
+    
+    // Unproven results are never stored
+    if ((_RESULT.wdl != WIN_CHAR) && (_RESULT.wdl != LOSS_CHAR) && (_RESULT.wdl != DRAW_CHAR))
+    {
+        return false;
+    }
+    
+    if (((_db->header->count + 1) << 2 > _db->header->capacity * 3) && !Database_grow(_db))
+    {
+        return false;
+    }
+    
+    _db->header->count += Database_insert(_db, &key, DB_USED | Tablebase_encode(_RESULT));
+    
+    return true;
+}
+
+void Database_storeLine(Database* restrict _db, const Make7* restrict _M7, Result _result, const uint8_t* restrict _PV, const int _LENGTH)
+{
+    Make7 m7 = *_M7;
+    
+    Database_store(_db, &m7, _result);
+    
+    // Every move along the line hands the opponent the other side of the result, one ply closer
+    for (int i = 0; (i < _LENGTH) && (_result.wdl != DRAW_CHAR) && _result.dt7; i++)
+    {
+        Make7_drop(&m7, _PV[i] >> 4, _PV[i] & 0xf);
+        _result = (Result) { (_result.wdl == WIN_CHAR) ? LOSS_CHAR : WIN_CHAR, _result.dt7 - 1 };
+        Database_store(_db, &m7, _result);
+    }
+}
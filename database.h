@@ -0,0 +1,81 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    The solved-position database keeps the results of earlier solves on disk, so that analyzing the same openings again does not start cold.
+    After every solve, the root position and every position along its principal variation are added with their exact results.
+    Negamax looks positions up at the root and at every node of its search, so even a different position that transposes into a solved one benefits.
+    
+    The file is a hash table of fixed-size entries behind a short header, mapped into memory as it is; lookups read it in place without loading it first.
+    Positions are stored under the same canonical keys as the endgame tablebase, so mirror images share an entry.
+    Collisions are resolved by linear probing, and the file doubles in size once it is three quarters full.
+    Only the thread that runs the solves writes to it, between searches, so the searching threads can read it without locks.
+*/
+
+#ifndef DATABASE_H
+#define DATABASE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "make7.h"
+#include "result.h"
+#include "tablebase.h"
+
+#define DB_MAGIC "M7DB"
+#define DB_VERSION 1
+
+// Number of entries in a new database; always a power of two
+#define DB_CAPACITY 4096
+
+// Marks an entry in use, above the tablebase encoding of its result
+#define DB_USED 0x100
+
+// The start of the file
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t capacity, count;
+}
+DB_Header;
+
+// A single entry of the database; zero while the slot is empty
+typedef struct
+{
+    TB_Key key;
+    uint64_t value;
+}
+DB_Entry;
+
+// The database itself
+typedef struct Database
+{
+    DB_Header *header;
+    DB_Entry *entry;
+    const char *path;
+    int fd;
+}
+Database;
+
+// Memory and I/O
+bool Database_map(Database*, const uint64_t);                                                           // Map the file in at a capacity, growing it to fit
+bool Database_open(Database*, const char*);                                                             // Open a database, creating it if it does not exist
+void Database_close(Database*);                                                                         // Write it back and release it
+
+// Lookups
+size_t Database_index(const TB_Key*, const uint64_t);                                                   // The first slot a position's keys are probed at
+bool Database_load(const Database*, const Make7*, Result*);                                             // Look up the result of a position; false if never solved
+bool Database_insert(Database*, const TB_Key*, const uint64_t);                                         // Put an entry into its slot, replacing an older one of the same position
+bool Database_grow(Database*);                                                                          // Double its capacity and put every entry back
+bool Database_store(Database*, const Make7*, const Result);                                             // Add the result of a position
+void Database_storeLine(Database*, const Make7*, Result, const uint8_t*, const int);                    // Add a solved position and every position along its principal variation
+
+#endif /* DATABASE_H */
@@ -0,0 +1,379 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "dfpn.h"
+
+bool DfpnContext_initialize(DfpnContext* restrict _ctx, ThreadPool* restrict _pool, const size_t _SIZE)
+{
+    // The calling thread counts at index 0, pool workers after it
+    _ctx->pool = _pool;
+    _ctx->counterCount = _pool->count + 1;
+    _ctx->attacker = false;
+    atomic_init(&_ctx->stop, false);
+    
+    if (!(_ctx->counters = calloc(_ctx->counterCount, sizeof(*_ctx->counters))) || !(_ctx->busy = calloc(DFPN_BUSY_SIZE, sizeof(*_ctx->busy))))
+    {
+        return false;
+    }
+    
+    if (!ProofTable_initialize(&_ctx->table, _SIZE))
+    {
+        return false;
+    }
+    
+    // Every worker probes the table, so no node should hold all of it
+    Numa_interleave(_ctx->table.entry, _ctx->table.size * sizeof(*_ctx->table.entry));
+    
+    return true;
+}
+
+void DfpnContext_destroy(DfpnContext* restrict _ctx)
+{
+    free(_ctx->counters);
+    free(_ctx->busy);
+    _ctx->counters = nullptr;
+    _ctx->busy = nullptr;
+    _ctx->counterCount = 0;
+    ProofTable_destroy(&_ctx->table);
+}
+
+void DfpnThread_initialize(DfpnThread* restrict _dt, DfpnContext* restrict _ctx)
+{
+    _dt->ctx = _ctx;
+    
+    // The counter belongs to whichever thread calls this, so it must be the thread that searches
+    _dt->nodes = &_ctx->counters[poolWorkerID + 1].count;
+}
+
+unsigned long long Dfpn_nodes(const DfpnContext* restrict _CTX)
+{
+    unsigned long long total = 0;
+    
+    for (int i = 0; i < _CTX->counterCount; i++)
+    {
+        total += atomic_load_explicit(&_CTX->counters[i].count, memory_order_relaxed);
+    }
+    
+    return total;
+}
+
+void Dfpn_resetNodes(DfpnContext* restrict _ctx)
+{
+    for (int i = 0; i < _ctx->counterCount; i++)
+    {
+        atomic_store_explicit(&_ctx->counters[i].count, 0, memory_order_relaxed);
+    }
+}
+
+inline uint32_t Dfpn_add(const uint32_t _A, const uint32_t _B)
+{
+    if ((_A == DFPN_INFINITY) || (_B == DFPN_INFINITY))
+    {
+        return DFPN_INFINITY;
+    }
+    
+    return (_A < DFPN_INFINITY - 1 - _B) ? _A + _B : DFPN_INFINITY - 1;
+}
+
+void Dfpn_lookup(DfpnContext* restrict _ctx, const Make7* restrict _M7, uint32_t* restrict _phi, uint32_t* restrict _delta, uint8_t* restrict _depth)
+{
+    uint32_t proof, disproof;
+    bool attacking = _M7->turn == _ctx->attacker;
+    
+    // The guard row is never set, so it tells apart proofs made for either player in the same position
+    if (!ProofTable_load(&_ctx->table, Make7_hashEncode(_M7), _M7->tiles23[0], _M7->tiles23[1] ^ (attacking ? 0 : MAKE7_TOP), &proof, &disproof, _depth))
+    {
+        proof = disproof = 1;
+        *_depth = 0;
+    }
+    
+    // The attacker wants to prove, the defender to disprove
+    *_phi = attacking ? proof : disproof;
+    *_delta = attacking ? disproof : proof;
+}
+
+void Dfpn_save(DfpnContext* restrict _ctx, const Make7* restrict _M7, const uint32_t _PHI, const uint32_t _DELTA, const uint8_t _DEPTH)
+{
+    bool attacking = _M7->turn == _ctx->attacker;
+    
+    ProofTable_store(&_ctx->table, Make7_hashEncode(_M7), _M7->tiles23[0], _M7->tiles23[1] ^ (attacking ? 0 : MAKE7_TOP), attacking ? _PHI : _DELTA, attacking ? _DELTA : _PHI, _DEPTH);
+}
+
+atomic_uint* Dfpn_busy(DfpnContext* restrict _ctx, const Make7* restrict _M7)
+{
+    return &_ctx->busy[(Make7_hashEncode(_M7) ^ (_M7->tiles23[0] * 0x9e3779b97f4a7c15ull) ^ (_M7->tiles23[1] * 0xc2b2ae3d27d4eb4full)) % DFPN_BUSY_SIZE];
+}
+
+uint8_t Dfpn_children(const Make7* restrict _M7, Make7* restrict _child, uint8_t* restrict _move)
+{
+    uint8_t list[MAKE7_SIZE_X3], total, count = 0;
+    
+    // Mirrored siblings prove the same, so a symmetrical grid only needs its left half
+    bool mirror = Make7_symmetrical(_M7);
+    
+    Make7_generate(_M7, list, &total);
+    
+    for (uint8_t mv = 0; mv < total; mv++)
+    {
+        if (mirror && ((list[mv] & 0xf) > (MAKE7_SIZE >> 1)))
+        {
+            continue;
+        }
+        
+        _child[count] = *_M7;
+        Make7_drop(&_child[count], list[mv] >> 4, list[mv] & 0xf);
+        _move[count++] = list[mv];
+    }
+    
+    return count;
+}
+
+void Dfpn_search(DfpnThread* restrict _dt, const Make7* restrict _M7, const uint32_t _TH_PHI, const uint32_t _TH_DELTA)
+{
+    DfpnContext *ctx = _dt->ctx;
+    Make7 child[MAKE7_SIZE_X3];
+    atomic_uint *busy, *childBusy[MAKE7_SIZE_X3];
+    uint8_t move[MAKE7_SIZE_X3], count, mv, bestChild, childDepth, winDepth, lossDepth;
+    uint32_t phi, delta, childPhi, childDelta, virtualDelta, bestDelta, secondDelta, bestPhi;
+    uint64_t others;
+    
+    // Only this thread writes its counter, so it needs no locked instruction
+    atomic_store_explicit(_dt->nodes, atomic_load_explicit(_dt->nodes, memory_order_relaxed) + 1, memory_order_relaxed);
+    
+    // Whoever makes 7 next has won; the attacker proves the node, the defender disproves it
+    if (Make7_checkFor7(_M7))
+    {
+        Dfpn_save(ctx, _M7, 0, DFPN_INFINITY, 0);
+        return;
+    }
+    
+    // A draw is never a win for the attacker
+    if (Make7_noMoreMoves(_M7))
+    {
+        Dfpn_save(ctx, _M7, (_M7->turn == ctx->attacker) ? DFPN_INFINITY : 0, (_M7->turn == ctx->attacker) ? 0 : DFPN_INFINITY, 0);
+        return;
+    }
+    
+    count = Dfpn_children(_M7, child, move);
+    
+    for (mv = 0; mv < count; mv++)
+    {
+        childBusy[mv] = Dfpn_busy(ctx, &child[mv]);
+    }
+    
+    // Let the other threads know we are in here
+    atomic_fetch_add_explicit((busy = Dfpn_busy(ctx, _M7)), 1, memory_order_relaxed);
+    
+    for (;;)
+    {
+        // The side to move needs only one child to go its way, but every child to go the other way
+        phi = bestDelta = secondDelta = DFPN_INFINITY;
+        delta = bestPhi = 0;
+        bestChild = 0;
+        winDepth = UINT8_MAX;
+        lossDepth = 0;
+        
+        for (mv = 0; mv < count; mv++)
+        {
+            Dfpn_lookup(ctx, &child[mv], &childPhi, &childDelta, &childDepth);
+            delta = Dfpn_add(delta, childPhi);
+            
+            if (childDelta < phi)
+            {
+                phi = childDelta;
+            }
+            
+            // A child other threads are inside of looks that much harder, so that we spread out instead of following them
+            // It never looks past our threshold though, or we might pick a child whose real numbers cannot make any progress
+            virtualDelta = childDelta;
+            
+            if ((others = atomic_load_explicit(childBusy[mv], memory_order_relaxed)) && childDelta && (childDelta < _TH_PHI))
+            {
+                virtualDelta = (childDelta * (others + 1) < _TH_PHI - 1) ? childDelta * (others + 1) : _TH_PHI - 1;
+            }
+            
+            if (virtualDelta < bestDelta)
+            {
+                secondDelta = bestDelta;
+                bestDelta = virtualDelta;
+                bestPhi = childPhi;
+                bestChild = mv;
+            }
+            else if (virtualDelta < secondDelta)
+            {
+                secondDelta = virtualDelta;
+            }
+            
+            // Win as soon as possible, and lose as late as possible
+            if (!childDelta && (childDepth < winDepth))
+            {
+                winDepth = childDepth;
+            }
+            
+            if (childDepth > lossDepth)
+            {
+                lossDepth = childDepth;
+            }
+        }
+        
+        if ((phi >= _TH_PHI) || (delta >= _TH_DELTA))
+        {
+            break;
+        }
+        
+        // The root was settled by another thread; what we have is only partly updated, so leave it as it was
+        if (atomic_load_explicit(&ctx->stop, memory_order_relaxed))
+        {
+            atomic_fetch_sub_explicit(busy, 1, memory_order_relaxed);
+            return;
+        }
+        
+        // The best child may use up our margin on the other number, and run a quarter past the second best before we switch back; a margin of one would keep swapping between the two
+        Dfpn_search(_dt, &child[bestChild], _TH_DELTA - delta + bestPhi, ((uint64_t)(secondDelta) + (secondDelta >> 2) + 1 < _TH_PHI) ? secondDelta + (secondDelta >> 2) + 1 : _TH_PHI);
+    }
+    
+    atomic_fetch_sub_explicit(busy, 1, memory_order_relaxed);
+    Dfpn_save(ctx, _M7, phi, delta, !phi ? winDepth + 1 : (!delta ? lossDepth + 1 : 0));
+}
+
+bool Dfpn_settled(DfpnContext* restrict _ctx, const Make7* restrict _M7, uint8_t* restrict _depth)
+{
+    uint32_t phi, delta;
+    
+    Dfpn_lookup(_ctx, _M7, &phi, &delta, _depth);
+    
+    return !phi || !delta;
+}
+
+bool Dfpn_prove(DfpnThread* restrict _dt, const Make7* restrict _M7, const bool _ATTACKER, uint8_t* restrict _depth)
+{
+    uint32_t phi, delta;
+    
+    _dt->ctx->attacker = _ATTACKER;
+    
+    // Thresholds just short of infinity only stop at a proof or a disproof, but the numbers may need a few more passes to settle
+    while (!Dfpn_settled(_dt->ctx, _M7, _depth))
+    {
+        Dfpn_search(_dt, _M7, DFPN_INFINITY - 1, DFPN_INFINITY - 1);
+    }
+    
+    Dfpn_lookup(_dt->ctx, _M7, &phi, &delta, _depth);
+    
+    return (_M7->turn == _ATTACKER) ? !phi : !delta;
+}
+
+int Dfpn_worker(void *_args)
+{
+    DfpnArgs *da = _args;
+    DfpnThread worker;
+    uint8_t depth;
+    
+    DfpnThread_initialize(&worker, da->ctx);
+    
+    // Work on the root until someone settles it, then tell everyone else to stop
+    while (!atomic_load(&da->ctx->stop))
+    {
+        if (Dfpn_settled(da->ctx, &da->m7, &depth))
+        {
+            atomic_store(&da->ctx->stop, true);
+            break;
+        }
+        
+        Dfpn_search(&worker, &da->m7, DFPN_INFINITY - 1, DFPN_INFINITY - 1);
+    }
+    
+    return 0;
+}
+
+bool Dfpn_prove_parallel(DfpnContext* restrict _ctx, const Make7* restrict _M7, const bool _ATTACKER, uint8_t* restrict _depth)
+{
+    DfpnArgs args = {.m7 = *_M7, .ctx = _ctx};
+    DfpnThread mainThread;
+    
+    _ctx->attacker = _ATTACKER;
+    atomic_store(&_ctx->stop, false);
+    
+    for (int wkr = 0; wkr < _ctx->pool->count; wkr++)
+    {
+        ThreadPool_submit(_ctx->pool, Dfpn_worker, &args);
+    }
+    
+    ThreadPool_wait(_ctx->pool);
+    atomic_store(&_ctx->stop, false);
+    
+    // A thread that unwound at the wrong moment may leave the root a pass short of settled
+    DfpnThread_initialize(&mainThread, _ctx);
+    
+    return Dfpn_prove(&mainThread, _M7, _ATTACKER, _depth);
+}
+
+uint8_t Dfpn_bestMove(DfpnThread* restrict _dt, const Make7* restrict _M7)
+{
+    Make7 child[MAKE7_SIZE_X3];
+    uint8_t move[MAKE7_SIZE_X3], count, mv, best, depth, bestDepth;
+    uint32_t phi, delta;
+    bool succeeded;
+    
+    count = Dfpn_children(_M7, child, move);
+    Dfpn_lookup(_dt->ctx, _M7, &phi, &delta, &depth);
+    succeeded = !phi;
+    best = move[0];
+    bestDepth = succeeded ? UINT8_MAX : 0;
+    
+    // When the side to move got its way, take the quickest child that did it; otherwise, every child failed it, so hold out the longest
+    for (mv = 0; mv < count; mv++)
+    {
+        // Entries can be overwritten since the proof; settle the child again if so
+        if (!succeeded)
+        {
+            Dfpn_prove(_dt, &child[mv], _dt->ctx->attacker, &depth);
+        }
+        
+        Dfpn_lookup(_dt->ctx, &child[mv], &phi, &delta, &depth);
+        
+        if (succeeded ? (!delta && (depth < bestDepth)) : (depth > bestDepth))
+        {
+            best = move[mv];
+            bestDepth = depth;
+        }
+    }
+    
+    // None of the children that did it are left in the table; settle them one by one until one does
+    for (mv = 0; succeeded && (bestDepth == UINT8_MAX) && (mv < count); mv++)
+    {
+        Dfpn_prove(_dt, &child[mv], _dt->ctx->attacker, &depth);
+        Dfpn_lookup(_dt->ctx, &child[mv], &phi, &delta, &depth);
+        
+        if (!delta)
+        {
+            best = move[mv];
+            bestDepth = depth;
+        }
+    }
+    
+    return best;
+}
+
+Result Dfpn_solve(DfpnContext* restrict _ctx, Make7* restrict _m7, const bool _PARALLEL, uint8_t* restrict _bestMove)
+{
+    DfpnThread mainThread;
+    uint8_t depth;
+    Result result = RESULT_DRAW;
+    
+    DfpnThread_initialize(&mainThread, _ctx);
+    
+    // Can the player to move force a win? If not, can the opponent?
+    if (_PARALLEL ? Dfpn_prove_parallel(_ctx, _m7, _m7->turn, &depth) : Dfpn_prove(&mainThread, _m7, _m7->turn, &depth))
+    {
+        result = (Result) { WIN_CHAR, depth };
+    }
+    else if (_PARALLEL ? Dfpn_prove_parallel(_ctx, _m7, !_m7->turn, &depth) : Dfpn_prove(&mainThread, _m7, !_m7->turn, &depth))
+    {
+        result = (Result) { LOSS_CHAR, depth };
+    }
+    
+    *_bestMove = Dfpn_bestMove(&mainThread, _m7);
+    
+    return result;
+}
@@ -0,0 +1,88 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    Depth-first proof-number search (df-pn) is an alternative to negamax for positions with a forced win or loss.
+    Every node carries a proof number, the least number of leaves that must still be shown to be wins for the attacker to prove it, and a disproof number, the same for showing it is not.
+    The attacker picks the child with the smallest proof number, and the defender the one with the smallest disproof number, so the search goes straight down the most forcing line.
+    
+    Unlike proof-number search, the tree is not kept in memory. The numbers are stored to a proof-number table, and a subtree is left as soon as its numbers reach thresholds handed down by its parent.
+    There is no iterative deepening, so shallow layers are not searched again and again; a narrow forcing line is followed all the way down at once.
+    
+    A proof only tells whether a player can force a win, so a solve takes up to two of them: one for the player to move, then one for the opponent if the first fails.
+    When neither succeeds, the position is a draw.
+    The distance to 7 is the length of the proof that was found, which is not always the shortest one negamax would report.
+    
+    The parallel solver runs the same proof on every pool worker, sharing the proof-number table that is already safe to share without locks.
+    Each thread marks the nodes it is inside of. A child that other threads are busy with looks harder to solve than it is, by its numbers times one plus the number of them, so the next thread picks another child.
+    These virtual numbers only steer the choice of child, and are never stored; the real numbers of whatever a thread settles become table hits for everyone.
+*/
+
+#ifndef DFPN_H
+#define DFPN_H
+
+#include <stdint.h>
+
+#include "make7.h"
+#include "table.h"
+#include "result.h"
+#include "pool.h"
+#include "numa.h"
+#include "negamax.h"
+
+// Proof and disproof numbers of a solved node; sums of large numbers stop one short so that they never look solved
+#define DFPN_INFINITY UINT32_MAX
+
+// Number of counters marking the nodes that threads are inside of; positions that share one only make each other look busier
+#define DFPN_BUSY_SIZE 65536
+
+// Everything a proof-number solve shares between its threads
+typedef struct
+{
+    ProofTable table;                                                   // The proof-number table shared by every thread
+    ThreadPool *pool;                                                   // The worker threads that a parallel proof runs on
+    NodeCounter *counters;                                              // One per pool worker plus one for the calling thread at index 0
+    int counterCount;                                                   // The number of node counters
+    atomic_uint *busy;                                                  // How many threads are inside each node, by a hash of the position
+    atomic_bool stop;                                                   // Set once the root is settled so that the other threads unwind
+    bool attacker;                                                      // The player whose win is being proven
+}
+DfpnContext;
+
+// What a single thread needs to search
+typedef struct
+{
+    DfpnContext *ctx;
+    atomic_ullong *nodes;
+}
+DfpnThread;
+
+// Parallel proof task's parameters
+typedef struct
+{
+    Make7 m7;
+    DfpnContext *ctx;
+}
+DfpnArgs;
+
+// Solver context
+bool DfpnContext_initialize(DfpnContext*, ThreadPool*, const size_t);                                   // Allocate a proof-number table of the given number of entries on a thread pool
+void DfpnContext_destroy(DfpnContext*);                                                                 // Release the proof-number table and the counters
+void DfpnThread_initialize(DfpnThread*, DfpnContext*);                                                  // Prepare the calling thread to search
+unsigned long long Dfpn_nodes(const DfpnContext*);                                                      // Sum the node counters of all threads
+void Dfpn_resetNodes(DfpnContext*);                                                                     // Set all node counters back to zero
+
+// Proof-number search
+uint32_t Dfpn_add(const uint32_t, const uint32_t);                                                      // Add proof or disproof numbers, keeping infinity exact
+void Dfpn_lookup(DfpnContext*, const Make7*, uint32_t*, uint32_t*, uint8_t*);                           // Read the numbers of a position, seen from the side to move; an unseen one counts as one leaf
+void Dfpn_save(DfpnContext*, const Make7*, const uint32_t, const uint32_t, const uint8_t);              // Save them, seen from the side to move
+atomic_uint* Dfpn_busy(DfpnContext*, const Make7*);                                                     // The counter of threads inside a position
+uint8_t Dfpn_children(const Make7*, Make7*, uint8_t*);                                                  // Generate the child positions worth searching, skipping mirrored moves
+void Dfpn_search(DfpnThread*, const Make7*, const uint32_t, const uint32_t);                            // Search until the numbers of the side to move reach the thresholds
+bool Dfpn_settled(DfpnContext*, const Make7*, uint8_t*);                                                // Whether the position is proven or disproven, and the length of the proof
+bool Dfpn_prove(DfpnThread*, const Make7*, const bool, uint8_t*);                                       // Prove or disprove that a player forces a win, and return the length of the proof
+int Dfpn_worker(void*);                                                                                 // Parallel proof task
+bool Dfpn_prove_parallel(DfpnContext*, const Make7*, const bool, uint8_t*);                             // Prove or disprove it with every pool worker
+uint8_t Dfpn_bestMove(DfpnThread*, const Make7*);                                                       // Pick the move the last proof relies on
+Result Dfpn_solve(DfpnContext*, Make7*, const bool, uint8_t*);                                          // Solve a position, serially or in parallel, and return its best move
+
+#endif /* DFPN_H */
@@ -0,0 +1,266 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "engine.h"
+
+// Ready the engine for its next search once one is over; a stop only ever cuts one search short, whichever kind it was
+static inline void Make7Engine_settle(Make7Engine* restrict _engine)
+{
+    atomic_store(&_engine->solver.stop, false);
+    atomic_store(&_engine->mcts.run, true);
+}
+
+// Hand a result over as the interface spells it
+static inline Make7EngineResult Make7Engine_result(const Result _R)
+{
+    return (Make7EngineResult) {_R.wdl, (_R.wdl == DRAW_CHAR) ? 0 : _R.dt7};
+}
+
+MAKE7_API int Make7Engine_version(void)
+{
+    return MAKE7_ENGINE_VERSION;
+}
+
+MAKE7_API Make7Engine *Make7Engine_create(const int _THREADS, const size_t _MEGABYTES)
+{
+    Make7Engine *engine = calloc(1, sizeof(*engine));
+    
+    if (!engine)
+    {
+        return nullptr;
+    }
+    
+    if (!ThreadPool_initialize(&engine->pool, (_THREADS > 0) ? _THREADS : ThreadPool_processors(), nullptr))
+    {
+        free(engine);
+        return nullptr;
+    }
+    
+    // The table every thread probes is spread over the NUMA nodes before anything is written to it
+    if (!NegamaxContext_initialize(&engine->solver, &engine->pool) || !TransTable_initialize(&engine->solver.table, (_MEGABYTES ? _MEGABYTES : ENGINE_TABLE) * 1048576 / sizeof(TT_Entry)))
+    {
+        ThreadPool_destroy(&engine->pool);
+        NegamaxContext_destroy(&engine->solver);
+        free(engine);
+        return nullptr;
+    }
+    
+    Numa_interleave(engine->solver.table.entry, engine->solver.table.size * sizeof(*engine->solver.table.entry));
+    engine->solver.console = false;
+    NegamaxThread_initialize(&engine->thread, &engine->solver, &engine->solver.table, 0);
+    MCTSContext_initialize(&engine->mcts, &engine->pool);
+    engine->mcts.console = false;
+    Make7_initialize(&engine->m7);
+    
+    return engine;
+}
+
+MAKE7_API void Make7Engine_destroy(Make7Engine* restrict _engine)
+{
+    if (_engine)
+    {
+        ThreadPool_destroy(&_engine->pool);
+        NegamaxContext_destroy(&_engine->solver);
+        free(_engine);
+    }
+}
+
+MAKE7_API void Make7Engine_clear(Make7Engine* restrict _engine)
+{
+    memset(_engine->solver.table.entry, 0, _engine->solver.table.size * sizeof(*_engine->solver.table.entry));
+}
+
+MAKE7_API void Make7Engine_reset(Make7Engine* restrict _engine)
+{
+    Make7_initialize(&_engine->m7);
+}
+
+MAKE7_API bool Make7Engine_setMoves(Make7Engine* restrict _engine, const char* restrict _SEQ)
+{
+    uint8_t moves[MAKE7_AREA];
+    Make7 m7;
+    
+    Make7_initialize(&m7);
+    
+    if (Make7_moves(&m7, _SEQ, moves) < 0)
+    {
+        return false;
+    }
+    
+    _engine->m7 = m7;
+    
+    return true;
+}
+
+MAKE7_API bool Make7Engine_setText(Make7Engine* restrict _engine, const char* restrict _TEXT)
+{
+    Make7 m7;
+    
+    if (!Position_fromText(_TEXT, &m7))
+    {
+        return false;
+    }
+    
+    _engine->m7 = m7;
+    
+    return true;
+}
+
+MAKE7_API bool Make7Engine_setCode(Make7Engine* restrict _engine, const uint8_t* restrict _CODE)
+{
+    PositionCode code;
+    Make7 m7;
+    
+    memcpy(code.byte, _CODE, sizeof(code.byte));
+    
+    if (!Position_decode(&code, &m7))
+    {
+        return false;
+    }
+    
+    _engine->m7 = m7;
+    
+    return true;
+}
+
+MAKE7_API bool Make7Engine_play(Make7Engine* restrict _engine, const uint8_t _MOVE)
+{
+    uint8_t tile = _MOVE >> 4, col = _MOVE & 0xf;
+    
+    return !Make7_gameOver(&_engine->m7) && (tile >= 1) && (tile <= 3) && (col < MAKE7_SIZE) && Make7_drop(&_engine->m7, tile, col);
+}
+
+MAKE7_API void Make7Engine_getText(const Make7Engine* restrict _ENGINE, char* restrict _text)
+{
+    Position_toText(&_ENGINE->m7, _text);
+}
+
+MAKE7_API void Make7Engine_getCode(const Make7Engine* restrict _ENGINE, uint8_t* restrict _code)
+{
+    PositionCode code;
+    
+    Position_encode(&_ENGINE->m7, &code);
+    memcpy(_code, code.byte, sizeof(code.byte));
+}
+
+MAKE7_API bool Make7Engine_over(const Make7Engine* restrict _ENGINE)
+{
+    return Make7_gameOver(&_ENGINE->m7) || Make7_noMoreMoves(&_ENGINE->m7) || Make7_gridFull(&_ENGINE->m7);
+}
+
+MAKE7_API Make7EngineResult Make7Engine_solve(Make7Engine* restrict _engine, const Make7EngineLimits* restrict _LIMITS, uint8_t* restrict _best)
+{
+    Result result = RESULT_UNKNOWN;
+    uint8_t best = 0;
+    
+    _engine->length = 0;
+    Negamax_resetNodes(&_engine->solver);
+    
+    if (!Make7Engine_over(_engine))
+    {
+        if (_LIMITS && (_LIMITS->nodes || (_LIMITS->seconds > 0.0)))
+        {
+            result = Negamax_solve_limited(&_engine->thread, &_engine->m7, (NegamaxLimits) {_LIMITS->nodes, _LIMITS->seconds}, &best, false);
+        }
+        else
+        {
+            result = (_engine->pool.count > 1) ? Negamax_solve_lazy(&_engine->solver, &_engine->m7, false) : Negamax_solve(&_engine->thread, &_engine->m7, false);
+            
+            // A solve cut short proves nothing and has no line to follow
+            if (atomic_load(&_engine->solver.stop) || (result.wdl == UNKNOWN_CHAR))
+            {
+                result = RESULT_UNKNOWN;
+            }
+            else
+            {
+                _engine->length = Negamax_principalVariation(&_engine->thread, &_engine->m7, result, _engine->line);
+                best = _engine->length ? _engine->line[0] : (result.wdl == DRAW_CHAR) ? Negamax_drawingMove(&_engine->thread, &_engine->m7) : 0;
+            }
+        }
+    }
+    
+    _engine->nodes = Negamax_nodes(&_engine->solver);
+    Make7Engine_settle(_engine);
+    
+    if (_best)
+    {
+        *_best = best;
+    }
+    
+    return Make7Engine_result(result);
+}
+
+MAKE7_API bool Make7Engine_analyze(Make7Engine* restrict _engine, Make7EngineResult* restrict _results)
+{
+    Result r1[MAKE7_SIZE], r2[MAKE7_SIZE], r3[MAKE7_SIZE];
+    int col;
+    bool stopped;
+    
+    for (col = 0; col < MAKE7_SIZE_X3; col++)
+    {
+        _results[col] = Make7Engine_result(RESULT_UNKNOWN);
+    }
+    
+    if (Make7Engine_over(_engine))
+    {
+        return false;
+    }
+    
+    Negamax_resetNodes(&_engine->solver);
+    Negamax_analyze(&_engine->solver, &_engine->m7, r1, r2, r3);
+    _engine->nodes = Negamax_nodes(&_engine->solver);
+    stopped = atomic_load(&_engine->solver.stop);
+    Make7Engine_settle(_engine);
+    
+    for (col = 0; col < MAKE7_SIZE; col++)
+    {
+        _results[col] = Make7Engine_result(r1[col]);
+        _results[MAKE7_SIZE + col] = Make7Engine_result(r2[col]);
+        _results[2 * MAKE7_SIZE + col] = Make7Engine_result(r3[col]);
+    }
+    
+    return !stopped;
+}
+
+MAKE7_API uint8_t Make7Engine_mcts(Make7Engine* restrict _engine, const double _SECONDS, double* restrict _points)
+{
+    uint8_t move = 0;
+    
+    // Without a time limit the search would only end once the root is solved
+    if ((_SECONDS > 0.0) && !Make7Engine_over(_engine))
+    {
+        _engine->mcts.seconds = _SECONDS;
+        
+        // The search draws from the calling thread's generator; tell engines searching at the same moment apart by their address
+        init_genrand(time(nullptr) + clock() + (uintptr_t)_engine);
+        move = MCTS_search(&_engine->mcts, &_engine->m7, nullptr, false);
+    }
+    
+    Make7Engine_settle(_engine);
+    
+    if (_points)
+    {
+        *_points = move ? _engine->mcts.result.meanPts : 0.0;
+    }
+    
+    return move;
+}
+
+MAKE7_API void Make7Engine_stop(Make7Engine* restrict _engine)
+{
+    atomic_store(&_engine->solver.stop, true);
+    atomic_store(&_engine->mcts.run, false);
+}
+
+MAKE7_API int Make7Engine_line(const Make7Engine* restrict _ENGINE, uint8_t* restrict _line)
+{
+    memcpy(_line, _ENGINE->line, _ENGINE->length);
+    
+    return _ENGINE->length;
+}
+
+MAKE7_API unsigned long long Make7Engine_nodes(const Make7Engine* restrict _ENGINE)
+{
+    return _ENGINE->nodes;
+}
@@ -0,0 +1,41 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    The engine behind the library's interface in libmake7.h, built on the same solver state the command line uses.
+    An engine owns its thread pool, its negamax and Monte Carlo tree search contexts, and the position it is set to, so engines never touch each other.
+    Both contexts are told they are embedded, so neither catches Ctrl-C nor rings the terminal bell, and every search runs without printing.
+    Exact solves run on the calling thread alone with one worker, and as Lazy SMP over the shared table with more.
+*/
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "libmake7.h"
+#include "make7.h"
+#include "position.h"
+#include "table.h"
+#include "numa.h"
+#include "result.h"
+#include "pool.h"
+#include "negamax.h"
+#include "mcts.h"
+
+// Megabytes of table when none is asked for
+#define ENGINE_TABLE 1024
+
+struct Make7Engine
+{
+    ThreadPool pool;                                                    // The engine's own worker threads
+    NegamaxContext solver;                                              // Its negamax state and transposition table
+    NegamaxThread thread;                                               // The calling thread's view of it
+    MCTSContext mcts;                                                   // Its Monte Carlo tree search state
+    Make7 m7;                                                           // The position it is set to
+    uint8_t line[MAKE7_AREA];                                           // The principal variation of the last exact solve
+    int length;
+    unsigned long long nodes;                                           // Nodes searched by the last solve or analysis
+};
+
+#endif /* ENGINE_H */
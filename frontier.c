@@ -0,0 +1,412 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "frontier.h"
+
+bool Frontier_enumerate(const Make7* restrict _ROOT, const uint8_t _PLIES, const char* restrict _DIR)
+{
+    TB_Position *layer = malloc(sizeof(*layer)), *next;
+    FrontierHeader header = { .version = FRONTIER_VERSION, .root = *_ROOT, .plies = _PLIES };
+    char path[FRONTIER_PATH], temporary[FRONTIER_PATH];
+    size_t count = 1;
+    bool success = layer;
+    FILE *file;
+    
+    if (success)
+    {
+        layer->m7 = *_ROOT;
+        layer->key = Tablebase_key(_ROOT);
+    }
+    
+    // The same expansion as the endgame tablebase, so transpositions and mirror images become one unit
+    for (uint8_t ply = 1; success && (ply <= _PLIES); ply++)
+    {
+        success = ((count = Tablebase_expand(layer, count, &next)) != SIZE_MAX);
+        free(layer);
+        layer = next;
+        printf("Ply %u: %llu positions\n", Make7_plyNum(_ROOT) + ply, (unsigned long long)(success ? count : 0));
+    }
+    
+    memcpy(header.magic, FRONTIER_MAGIC, 4);
+    header.count = count;
+    snprintf(path, sizeof(path), "%s/units", _DIR);
+    snprintf(temporary, sizeof(temporary), "%s/units.tmp", _DIR);
+    
+    // Written under another name first, so that a crash never leaves a half-written file of units behind
+    if (success && (success = (file = fopen(temporary, "wb"))))
+    {
+        success = (fwrite(&header, sizeof(header), 1, file) == 1);
+        
+        for (size_t pos = 0; success && (pos < count); pos++)
+        {
+            success = (fwrite(&layer[pos].m7, sizeof(layer[pos].m7), 1, file) == 1);
+        }
+        
+        success = !fclose(file) && success && !rename(temporary, path);
+    }
+    
+    free(layer);
+    
+    return success;
+}
+
+Make7 *Frontier_loadUnits(const char* restrict _DIR, const Make7* restrict _ROOT, const uint8_t _PLIES, size_t* restrict _count)
+{
+    FrontierHeader header;
+    char path[FRONTIER_PATH];
+    Make7 *units = nullptr;
+    FILE *file;
+    
+    snprintf(path, sizeof(path), "%s/units", _DIR);
+    
+    if (!(file = fopen(path, "rb")))
+    {
+        return nullptr;
+    }
+    
+    // Units enumerated from another root or to another ply cannot be mixed with this run
+    if ((fread(&header, sizeof(header), 1, file) == 1) && !memcmp(header.magic, FRONTIER_MAGIC, 4) && (header.version == FRONTIER_VERSION) && (header.plies == _PLIES) && !memcmp(&header.root, _ROOT, sizeof(*_ROOT))
+        && (units = malloc((header.count ? header.count : 1) * sizeof(*units))) && (fread(units, sizeof(*units), header.count, file) != header.count))
+    {
+        free(units);
+        units = nullptr;
+    }
+    
+    fclose(file);
+    *_count = units ? header.count : 0;
+    
+    return units;
+}
+
+void Frontier_loadResults(const char* restrict _DIR, uint8_t* restrict _values, const size_t _COUNT)
+{
+    FrontierRecord record;
+    char path[FRONTIER_PATH];
+    FILE *file;
+    
+    memset(_values, TB_UNKNOWN, _COUNT);
+    
+    // Slices may have been run on other machines, so every result file there can be is looked for
+    for (int slice = 0; slice < FRONTIER_SLICES; slice++)
+    {
+        snprintf(path, sizeof(path), "%s/results.%d", _DIR, slice);
+        
+        if (!(file = fopen(path, "rb")))
+        {
+            continue;
+        }
+        
+        while (fread(&record, sizeof(record), 1, file) == 1)
+        {
+            if ((record.unit < _COUNT) && (_values[record.unit] == TB_UNKNOWN))
+            {
+                _values[record.unit] = record.value;
+            }
+        }
+        
+        fclose(file);
+    }
+}
+
+bool Frontier_solveSlice(NegamaxContext* restrict _ctx, const char* restrict _DIR, const Make7* restrict _UNITS, const uint8_t* restrict _VALUES, const size_t _COUNT, const int _SLICE, const int _SLICES, const NegamaxLimits _LIMITS)
+{
+    FrontierRecord record, *kept = nullptr;
+    NegamaxThread worker;
+    char path[FRONTIER_PATH];
+    size_t whole = 0;
+    uint8_t move;
+    Result result;
+    FILE *file;
+    
+    snprintf(path, sizeof(path), "%s/results.%d", _DIR, _SLICE);
+    
+    // A worker killed while writing leaves a record cut short at the end of its file; rewrite the file without it
+    if ((file = fopen(path, "rb")))
+    {
+        while (fread(&record, sizeof(record), 1, file) == 1)
+        {
+            FrontierRecord *grown = realloc(kept, (whole + 1) * sizeof(*kept));
+            
+            if (!grown)
+            {
+                fclose(file);
+                free(kept);
+                return false;
+            }
+            
+            kept = grown;
+            kept[whole++] = record;
+        }
+        
+        fclose(file);
+        
+        if (!(file = fopen(path, "wb")) || (fwrite(kept, sizeof(*kept), whole, file) != whole) | fclose(file))
+        {
+            free(kept);
+            return false;
+        }
+        
+        free(kept);
+    }
+    
+    if (!(file = fopen(path, "ab")))
+    {
+        return false;
+    }
+    
+    NegamaxThread_initialize(&worker, _ctx, &_ctx->table, 0);
+    
+    for (size_t unit = _SLICE; unit < _COUNT; unit += _SLICES)
+    {
+        Make7 m7 = _UNITS[unit];
+        
+        if (_VALUES[unit] != TB_UNKNOWN)
+        {
+            continue;
+        }
+        
+        // A unit over its time limit is recorded as unsolved, so that the next run tries it again
+        result = (_LIMITS.nodes || _LIMITS.seconds) ? Negamax_solve_limited(&worker, &m7, _LIMITS, &move, false) : Negamax_solve(&worker, &m7, false);
+        memset(&record, 0, sizeof(record));
+        record.unit = unit;
+        record.value = Tablebase_encode(result);
+        
+        // Every result goes to disk as soon as it is known
+        if ((fwrite(&record, sizeof(record), 1, file) != 1) || fflush(file))
+        {
+            fclose(file);
+            return false;
+        }
+        
+#ifdef __unix__
+        fsync(fileno(file));
+#endif
+        
+        printf("Unit %llu: ", (unsigned long long)(unit));
+        Result_print(&result, nullptr);
+        puts("");
+        fflush(stdout);
+    }
+    
+    return !fclose(file);
+}
+
+bool Frontier_solveLocal(NegamaxContext* restrict _ctx, const char* restrict _DIR, const Make7* restrict _UNITS, uint8_t* restrict _values, const size_t _COUNT, const int _WORKERS, const NegamaxLimits _LIMITS)
+{
+#ifdef __unix__
+    pid_t worker[_WORKERS], done;
+    int retries[_WORKERS], running = 0, status, w;
+    size_t tableSize = _ctx->table.size;
+    bool success = true;
+    
+    // Every worker gets its share of the memory meant for the table, and its own copy of whatever the parent holds
+    TransTable_destroy(&_ctx->table);
+    fflush(stdout);
+    
+    for (w = 0; w < _WORKERS; w++)
+    {
+        retries[w] = 0;
+        worker[w] = -1;
+    }
+    
+    for (w = 0; success && (w < _WORKERS); w++, running++)
+    {
+        if (!(worker[w] = fork()))
+        {
+            Numa_bind(w);
+            
+            // A worker started again rereads the results, so that it skips what its last run already solved
+            Frontier_loadResults(_DIR, _values, _COUNT);
+            _exit(TransTable_initialize(&_ctx->table, tableSize / _WORKERS) && Frontier_solveSlice(_ctx, _DIR, _UNITS, _values, _COUNT, w, _WORKERS, _LIMITS) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        
+        success = (worker[w] > 0);
+    }
+    
+    // Wait for every worker; one that died is started again on its slice a few times before giving up on it
+    while (running && ((done = wait(&status)) > 0))
+    {
+        for (w = 0; (w < _WORKERS) && (worker[w] != done); w++);
+        
+        if ((w == _WORKERS) || (WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS)))
+        {
+            running--;
+            continue;
+        }
+        
+        fprintf(stderr, "Worker #%d stopped unexpectedly.\n", w);
+        
+        if (success && (retries[w]++ < FRONTIER_RETRIES) && ((worker[w] = fork()) >= 0))
+        {
+            if (!worker[w])
+            {
+                Numa_bind(w);
+                Frontier_loadResults(_DIR, _values, _COUNT);
+                _exit(TransTable_initialize(&_ctx->table, tableSize / _WORKERS) && Frontier_solveSlice(_ctx, _DIR, _UNITS, _values, _COUNT, w, _WORKERS, _LIMITS) ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+        }
+        else
+        {
+            running--;
+            success = false;
+        }
+    }
+    
+    return success;
+#else
+    // Without fork, this process is the only worker
+    (void)(_WORKERS);
+    
+    return Frontier_solveSlice(_ctx, _DIR, _UNITS, _values, _COUNT, 0, 1, _LIMITS);
+#endif
+}
+
+bool Frontier_backup(NegamaxContext* restrict _ctx, const Make7* restrict _ROOT, const uint8_t _PLIES, const uint8_t* restrict _VALUES, const size_t _COUNT, Result* restrict _root, Result* restrict _r1, Result* restrict _r2, Result* restrict _r3)
+{
+    TB_Position **layer = calloc(_PLIES + 1, sizeof(*layer));
+    size_t *count = calloc(_PLIES + 1, sizeof(*count)), widest = 0, tasks;
+    uint8_t list[MAKE7_SIZE_X3], total;
+    TablebaseArgs *args = nullptr;
+    bool success = layer && count && (layer[0] = malloc(sizeof(**layer)));
+    
+    if (success)
+    {
+        layer[0]->m7 = *_ROOT;
+        layer[0]->key = Tablebase_key(_ROOT);
+        count[0] = 1;
+    }
+    
+    // The plies above the frontier are expanded again exactly as they were when the units were enumerated
+    for (uint8_t ply = 1; success && (ply <= _PLIES); ply++)
+    {
+        success = ((count[ply] = Tablebase_expand(layer[ply - 1], count[ply - 1], &layer[ply])) != SIZE_MAX);
+        widest = (count[ply - 1] > widest) ? count[ply - 1] : widest;
+    }
+    
+    success = success && (count[_PLIES] == _COUNT) && (args = malloc((widest / TB_CHUNK + 1) * sizeof(*args)));
+    
+    for (size_t pos = 0; success && (pos < _COUNT); pos++)
+    {
+        layer[_PLIES][pos].value = _VALUES[pos];
+    }
+    
+    // A small minimax over the frontier, one ply at a time, split between the pool workers
+    for (int ply = _PLIES - 1; success && (ply >= 0); ply--)
+    {
+        tasks = 0;
+        
+        for (size_t begin = 0; begin < count[ply]; begin += TB_CHUNK, tasks++)
+        {
+            args[tasks] = (TablebaseArgs) { _ctx, layer[ply], layer[ply + 1], begin, (begin + TB_CHUNK < count[ply]) ? begin + TB_CHUNK : count[ply], count[ply + 1] };
+            ThreadPool_submit(_ctx->pool, Tablebase_backupWorker, &args[tasks]);
+        }
+        
+        ThreadPool_wait(_ctx->pool);
+    }
+    
+    if (success)
+    {
+        *_root = Tablebase_decode(layer[0]->value);
+        
+        for (uint8_t col = 0; col < MAKE7_SIZE; col++)
+        {
+            _r1[col] = _r2[col] = _r3[col] = RESULT_UNKNOWN;
+        }
+        
+        // Every root move is the opposite of its child's result, one ply further
+        Make7_generate(_ROOT, list, &total);
+        
+        for (uint8_t mv = 0; mv < total; mv++)
+        {
+            TB_Position child = { .m7 = *_ROOT };
+            TB_Position *found;
+            Result *moveResult = ((list[mv] >> 4) == 1) ? _r1 : ((list[mv] >> 4) == 2) ? _r2 : _r3;
+            
+            Make7_drop(&child.m7, list[mv] >> 4, list[mv] & 0xf);
+            child.key = Tablebase_key(&child.m7);
+            
+            if ((found = bsearch(&child, layer[1], count[1], sizeof(*layer[1]), Tablebase_compare)))
+            {
+                moveResult[list[mv] & 0xf] = Tablebase_decode(found->value);
+                Result_increment(&moveResult[list[mv] & 0xf]);
+            }
+        }
+    }
+    
+    for (int ply = 0; layer && (ply <= _PLIES); ply++)
+    {
+        free(layer[ply]);
+    }
+    
+    free(layer);
+    free(count);
+    free(args);
+    
+    return success;
+}
+
+bool Frontier_run(NegamaxContext* restrict _ctx, const Make7* restrict _ROOT, const uint8_t _PLIES, const char* restrict _DIR, const int _SLICE, const int _SLICES, const NegamaxLimits _LIMITS, Result* restrict _root, Result* restrict _r1, Result* restrict _r2, Result* restrict _r3)
+{
+    Make7 *units;
+    uint8_t *values;
+    size_t count, solved = 0;
+    char path[FRONTIER_PATH];
+    bool success;
+    FILE *file;
+    
+#ifdef __unix__
+    mkdir(_DIR, 0755);
+#elif defined(_WIN64) || defined(_WIN32)
+    _mkdir(_DIR);
+#endif
+    
+    // Enumerate the units on the first run only; units of another root or ply are never replaced, since their results would be taken for the new ones
+    if (!(units = Frontier_loadUnits(_DIR, _ROOT, _PLIES, &count)))
+    {
+        snprintf(path, sizeof(path), "%s/units", _DIR);
+        
+        if ((file = fopen(path, "rb")))
+        {
+            fclose(file);
+            fprintf(stderr, "The work units in \"%s\" are of another position or ply.\n", _DIR);
+            return false;
+        }
+        
+        if (!Frontier_enumerate(_ROOT, _PLIES, _DIR) || !(units = Frontier_loadUnits(_DIR, _ROOT, _PLIES, &count)))
+        {
+            fprintf(stderr, "Could not write the work units to \"%s\".\n", _DIR);
+            return false;
+        }
+    }
+    
+    if (!(values = malloc(count ? count : 1)))
+    {
+        free(units);
+        return false;
+    }
+    
+    Frontier_loadResults(_DIR, values, count);
+    
+    for (size_t unit = 0; unit < count; unit++)
+    {
+        solved += (values[unit] != TB_UNKNOWN);
+    }
+    
+    printf("%llu of %llu units solved\n", (unsigned long long)(solved), (unsigned long long)(count));
+    
+    // One slice of a cluster run, or every slice on the processors of this machine
+    success = _SLICES ? Frontier_solveSlice(_ctx, _DIR, units, values, count, _SLICE, _SLICES, _LIMITS) : Frontier_solveLocal(_ctx, _DIR, units, values, count, _ctx->pool->count, _LIMITS);
+    
+    // Back up whatever is known by now; units still unsolved leave the root unsolved unless it is won regardless
+    if (success)
+    {
+        Frontier_loadResults(_DIR, values, count);
+        success = Frontier_backup(_ctx, _ROOT, _PLIES, values, count, _root, _r1, _r2, _r3);
+    }
+    
+    free(units);
+    free(values);
+    
+    return success;
+}
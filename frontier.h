@@ -0,0 +1,80 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    The frontier pipeline splits a solve too large for one search into many small ones, and is built to run unattended for as long as it takes.
+    First, every distinct position a number of plies below the root is enumerated, one of each pair of mirror images only, and written to a file of work units.
+    Then, worker processes solve the units, each one its own slice, and append every result to a result file of their own as soon as it is known.
+    Last, the results are backed up to the root through the plies above the frontier, the same way the endgame tablebase is generated.
+    
+    Every stage picks up where it left off: the units are only enumerated once, and a worker skips the units that already have a result in any result file.
+    A unit that runs out of its time limit is left unsolved and tried again by the next run, so a run with a longer limit finishes the hardest ones.
+    A worker that dies is started again on its slice, up to a few times, and a result record cut short by a crash is dropped.
+    On a cluster, every node runs one slice with --slice, over a directory they all share; the last run without it backs the results up.
+*/
+
+#ifndef FRONTIER_H
+#define FRONTIER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __unix__
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#elif defined(_WIN64) || defined(_WIN32)
+#include <direct.h>
+#endif
+
+#include "make7.h"
+#include "result.h"
+#include "tablebase.h"
+#include "negamax.h"
+#include "numa.h"
+
+#define FRONTIER_MAGIC "M7FU"
+#define FRONTIER_VERSION 1
+
+// The most slices the units can be split into, and so the most result files there can be
+#define FRONTIER_SLICES 4096
+
+// How many times a worker that died is started again
+#define FRONTIER_RETRIES 3
+
+// Length of a path inside the pipeline's directory
+#define FRONTIER_PATH 4096
+
+// The start of the file of work units
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+    Make7 root;
+    uint8_t plies;
+}
+FrontierHeader;
+
+// The result of a single work unit, as written to a result file
+typedef struct
+{
+    uint32_t unit;
+    uint8_t value;
+}
+FrontierRecord;
+
+// Work units
+bool Frontier_enumerate(const Make7*, const uint8_t, const char*);                                      // Write the distinct positions a number of plies below the root as work units
+Make7 *Frontier_loadUnits(const char*, const Make7*, const uint8_t, size_t*);                           // Read the work units back, checking that they belong to the same root
+void Frontier_loadResults(const char*, uint8_t*, const size_t);                                         // Gather the results of every result file; a proven one wins over an unsolved one
+
+// Solving
+bool Frontier_solveSlice(NegamaxContext*, const char*, const Make7*, const uint8_t*, const size_t, const int, const int, const NegamaxLimits); // Solve every unit of a slice that has no result yet
+bool Frontier_solveLocal(NegamaxContext*, const char*, const Make7*, uint8_t*, const size_t, const int, const NegamaxLimits); // Solve every slice in worker processes of its own
+
+// Backing up
+bool Frontier_backup(NegamaxContext*, const Make7*, const uint8_t, const uint8_t*, const size_t, Result*, Result*, Result*, Result*); // Back the results up to the root and its moves
+bool Frontier_run(NegamaxContext*, const Make7*, const uint8_t, const char*, const int, const int, const NegamaxLimits, Result*, Result*, Result*, Result*); // Run every stage of the pipeline
+
+#endif /* FRONTIER_H */
@@ -0,0 +1,37 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    The Make 7 solver as a library, with the interface declared in libmake7.h.
+    Like the driver in main.c, it includes the solver's sources directly, so that the whole engine is one translation unit and optimizes as one.
+    Everything but the interface is hidden from the shared library; the modules only the command line needs are left out.
+*/
+
+#define _POSIX_C_SOURCE 200809 // clock_gettime()
+#define _GNU_SOURCE // sched_setaffinity(), syscall()
+
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#if defined(_WIN64) || defined(_WIN32)
+#include <windows.h>
+#endif
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+// We will include source files directly for maximum performance
+#include "mt19937ar-cok.h"
+#include "make7.c"
+#include "position.c"
+#include "table.c"
+#include "numa.c"
+#include "result.c"
+#include "pool.c"
+#include "negamax.c"
+#include "tablebase.c"
+#include "database.c"
+#include "checkpoint.c"
+#include "mcts.c"
+#include "engine.c"
@@ -0,0 +1,96 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    The public interface of the Make 7 solver library, for programs that embed the engine instead of running the solver and reading its output.
+    It only needs the standard headers below; build the library with "make library" and link against libmake7.a or libmake7.so.
+    
+    An engine holds everything one solver needs: its worker threads, transposition table, Monte Carlo tree, and the position it is set to.
+    Nothing is shared between engines, so separate engines can be created, used and destroyed side by side on different threads.
+    One engine must only be used by one thread at a time, except for Make7Engine_stop, which any thread may call while it searches.
+    The library never prints, never catches signals and never exits; every failure is returned.
+    
+    Moves are one byte each, the tile in the upper four bits and the column, 0 for A to 6 for G, in the lower four; zero is no move.
+    Positions can be set from a move sequence such as "2d2d2c2d", from the text form such as "//2/2bb/// 1 11,9,4 11,9,4 D", or from the 24-byte binary form.
+    
+    Results are for the side to move: W and a number of plies for a win, L for a loss, D for a draw, and ? for a search cut short or a game already over.
+    The results of every move are seven per tile, ones first, each in column order; a move that cannot be played is unknown.
+    
+    Only what is declared here is exported from the shared library, and it keeps its meaning for as long as MAKE7_ENGINE_VERSION stays the same.
+*/
+
+#ifndef LIBMAKE7_H
+#define LIBMAKE7_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Changed whenever anything below changes in a way that breaks a program built against an earlier one
+#define MAKE7_ENGINE_VERSION 1
+
+// The bytes of a position's binary form, the longest text form with its terminator, and the results of every move
+#define MAKE7_ENGINE_CODE 24
+#define MAKE7_ENGINE_TEXT 80
+#define MAKE7_ENGINE_MOVES 21
+
+// Only the interface is visible outside the shared library
+#if defined(__GNUC__) && !(defined(_WIN64) || defined(_WIN32))
+#define MAKE7_API __attribute__((visibility("default")))
+#else
+#define MAKE7_API
+#endif
+
+// An engine; only ever handled through a pointer
+typedef struct Make7Engine Make7Engine;
+
+// A result for the side to move
+typedef struct
+{
+    char wdl;                                                           // 'W', 'L', 'D', or '?' if unknown
+    uint8_t dt7;                                                        // Plies to the win or loss
+}
+Make7EngineResult;
+
+// The budget of a search; zero means no limit
+typedef struct
+{
+    unsigned long long nodes;
+    double seconds;
+}
+Make7EngineLimits;
+
+// Setting up
+MAKE7_API int Make7Engine_version(void);                                                                // The version of the interface the library was built with
+MAKE7_API Make7Engine *Make7Engine_create(const int, const size_t);                                     // Start an engine with some threads and megabytes of table, or one per processor and a gigabyte if zero; null on failure
+MAKE7_API void Make7Engine_destroy(Make7Engine*);                                                       // Stop its threads and release everything it holds
+MAKE7_API void Make7Engine_clear(Make7Engine*);                                                         // Forget everything its table has proven
+
+// The position
+MAKE7_API void Make7Engine_reset(Make7Engine*);                                                         // Go back to the starting position
+MAKE7_API bool Make7Engine_setMoves(Make7Engine*, const char*);                                         // Play a move sequence from the starting position; false and unchanged if it is not one
+MAKE7_API bool Make7Engine_setText(Make7Engine*, const char*);                                          // Set a position from its text form; false and unchanged if it is not one
+MAKE7_API bool Make7Engine_setCode(Make7Engine*, const uint8_t*);                                       // Set a position from its binary form; false and unchanged if it is not one
+MAKE7_API bool Make7Engine_play(Make7Engine*, const uint8_t);                                           // Play one move; false and unchanged if it cannot be played
+MAKE7_API void Make7Engine_getText(const Make7Engine*, char*);                                          // Write the position in its text form
+MAKE7_API void Make7Engine_getCode(const Make7Engine*, uint8_t*);                                       // Write the position in its binary form
+MAKE7_API bool Make7Engine_over(const Make7Engine*);                                                    // Whether the game is over, so that there is nothing to search
+
+// Searching
+MAKE7_API Make7EngineResult Make7Engine_solve(Make7Engine*, const Make7EngineLimits*, uint8_t*);        // Solve the position, exactly without limits, and give a best move
+MAKE7_API bool Make7Engine_analyze(Make7Engine*, Make7EngineResult*);                                   // Solve every move exactly; false if the game is over or the search was stopped
+MAKE7_API uint8_t Make7Engine_mcts(Make7Engine*, const double, double*);                                // Search with Monte Carlo tree search for some seconds; its move and mean points
+MAKE7_API void Make7Engine_stop(Make7Engine*);                                                          // Cut the search running on another thread short, or the next one if none is
+
+// Reading results
+MAKE7_API int Make7Engine_line(const Make7Engine*, uint8_t*);                                           // The principal variation of the last exact solve; how many moves it has
+MAKE7_API unsigned long long Make7Engine_nodes(const Make7Engine*);                                     // Nodes searched by the last solve or analysis
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBMAKE7_H */
@@ -7,6 +7,7 @@
 */
 
 #define _POSIX_C_SOURCE 200809 // clock_gettime()
+#define _GNU_SOURCE // sched_setaffinity(), syscall()
 
 #include <string.h>
 #include <assert.h>
@@ -29,9 +30,22 @@
 #include "mt19937ar-cok.h"
 //#include "mt19937-64.h"
 #include "make7.c"
+#include "position.c"
 #include "table.c"
+#include "numa.c"
 #include "result.c"
+#include "pool.c"
 #include "negamax.c"
+#include "dfpn.c"
+#include "tablebase.c"
+#include "database.c"
+#include "book.c"
+#include "frontier.c"
+#include "checkpoint.c"
+#include "shared.c"
+#include "server.c"
+#include "batch.c"
+#include "annotate.c"
 //#include "barrier.c"
 #include "mcts.c"
 
@@ -47,12 +61,31 @@ int main(int argc, char **argv)
     static Make7 ms;
     static Result r, r1[MAKE7_SIZE], r2[MAKE7_SIZE], r3[MAKE7_SIZE];
     
+    // The worker threads and the state of each engine; nothing is shared between searches except through these
+    static ThreadPool pool;
+    static NegamaxContext solver;
+    static NegamaxThread mainThread;
+    static MCTSContext mcts;
+    static DfpnContext prover;
+    static Tablebase endgame;
+    static Database solved;
+    static Book openings;
+    static Checkpoint checkpoint;
+    static Shared shared;
+    static Server server;
+    static Batch batch;
+    static Annotation annotation;
+    
     // To see if the game state is the same after solving
     Make7 oldMS;
     
     // The best move found by Monte Carlo tree search; list of possible moves; total moves
     uint8_t best, mctsMove, totalMoves, movesList[MAKE7_SIZE_X3], m;
     
+    // The principal variation of the solved position and its length
+    uint8_t pvLine[MAKE7_AREA];
+    int pvLength;
+    
     // Character input; move input from user; interactive mode type
     char input, humanInput[3], type, argSeq[MAKE7_AREA_X2 + 1];
     
@@ -61,41 +94,118 @@ int main(int argc, char **argv)
     clock_t stopwatch;
     double sec, npsec;
     
+    // The budget of an anytime solve and the computer player
+    NegamaxLimits limits;
+    
     // Flags for the main loop
-    bool over, running, notFixedTable, monteCarloTS, interactive, parallel, humanMove, invalidMove, pgo;
+    bool over, running, notFixedTable, monteCarloTS, proofNumber, interactive, parallel, lazySMP, bestOnly, limited, humanMove, invalidMove, pgo;
     
     // The final calculated table size, used when setting up the transposition table for the first time
     size_t finalTTSize;
     
+    // The endgame tablebase to probe or to generate, and how many plies below the root to generate it to
+    const char *tablebasePath;
+    int tablebasePlies;
+    
+    // The database of positions solved by earlier runs
+    const char *databasePath;
+    
+    // The opening book to probe or to build, and how many plies from the root to build it to
+    const char *bookPath;
+    int bookPlies;
+    
+    // The directory of the frontier pipeline, how many plies from the root its work units are, and which slice of them this run solves
+    const char *frontierPath;
+    int frontierPlies, frontierSlice, frontierSlices;
+    
+    // Where to write checkpoints of a long solve and how many minutes apart, and whether to pick up from the last one
+    const char *checkpointPath;
+    double checkpointMinutes;
+    bool resume;
+    
+    // The shared-memory segment of a multi-process solve, how many worker processes to start on it, and whether to join one instead
+    const char *sharedName;
+    int processes;
+    bool joining;
+    
+    // The socket to answer queries on instead of reading standard input
+    const char *servePath;
+    
+    // The file of positions to solve in a batch, and the format to write their answers in
+    const char *batchPath;
+    enum BatchFormat batchFormat;
+    
+    // Whether to annotate the game given instead of solving its last position
+    bool annotate;
+    
+    // The processors the worker threads are pinned to, one each, and how many; whether to keep the priority we were started with
+    static int pinned[NUMA_BITS];
+    int pinCount;
+    bool normalPriority;
+    
     // Pointer to iterate the results to check for correctness
     int res;
     
-    // Lower our priority for other processes
-#if defined(_WIN64) || defined(_WIN32)
-    SetPriorityClass(GetCurrentProcess(), IDLE_PRIORITY_CLASS);
-#elifdef __linux__
-    setpriority(PRIO_PROCESS, getpid(), 19);
-#endif
-    
     // Read command-line arguments and set flags accordingly
     {
         int opt;
-        bool argTableNotDone, argMCTSNotDone, argInteractNotDone, argParallelNotDone, argSwapNotDone, argPGONotDone;
+        bool argTableNotDone, argMCTSNotDone, argDfpnNotDone, argTablebaseNotDone, argDatabaseNotDone, argBookNotDone, argFrontierNotDone, argSliceNotDone, argCheckpointNotDone, argResumeNotDone, argJoinNotDone, argInteractNotDone, argParallelNotDone, argBestNotDone, argTimeNotDone, argNodeNotDone, argSwapNotDone, argPGONotDone, argPinNotDone, argPriorityNotDone, argServeNotDone, argBatchNotDone, argAnnotateNotDone;
         
         // Default flag values
         monteCarloTS = false;
+        proofNumber = false;
         interactive = false;
         parallel = false;
+        lazySMP = false;
+        bestOnly = false;
+        limited = false;
+        limits = (NegamaxLimits) {0, 0.0};
         pgo = false;
         g_swapColors = false;
         argTableNotDone = true;
         argMCTSNotDone = true;
+        argDfpnNotDone = true;
+        argTablebaseNotDone = true;
+        argDatabaseNotDone = true;
+        argBookNotDone = true;
+        argFrontierNotDone = true;
+        argSliceNotDone = true;
+        argCheckpointNotDone = true;
+        argResumeNotDone = true;
+        argJoinNotDone = true;
         argInteractNotDone = true;
         argParallelNotDone = true;
+        argBestNotDone = true;
+        argTimeNotDone = true;
+        argNodeNotDone = true;
         argSwapNotDone = true;
         argPGONotDone = true;
+        argPinNotDone = true;
+        argPriorityNotDone = true;
+        argServeNotDone = true;
+        argBatchNotDone = true;
+        argAnnotateNotDone = true;
         notFixedTable = true;
         finalTTSize = 1;
+        tablebasePath = nullptr;
+        tablebasePlies = 0;
+        databasePath = nullptr;
+        bookPath = nullptr;
+        bookPlies = 0;
+        frontierPath = nullptr;
+        frontierPlies = frontierSlice = frontierSlices = 0;
+        checkpointPath = nullptr;
+        checkpointMinutes = CK_INTERVAL;
+        resume = false;
+        sharedName = SH_NAME;
+        processes = 0;
+        joining = false;
+        servePath = nullptr;
+        batchPath = nullptr;
+        batchFormat = BATCH_CSV;
+        annotate = false;
+        pinCount = 0;
+        normalPriority = false;
         argSeq[0] = '\0';
         
         if (argc >= 2)
@@ -129,6 +239,142 @@ int main(int argc, char **argv)
                             argMCTSNotDone = false;
                         }
                         
+                        // Proof-number search
+                        else if (argDfpnNotDone && !(strcmp(argv[opt], "-d") && strcmp(argv[opt], "--dfpn")))
+                        {
+                            proofNumber = true;
+                            argDfpnNotDone = false;
+                        }
+                        
+                        // Endgame tablebase to probe
+                        else if (argTablebaseNotDone && !(strcmp(argv[opt], "-e") && strcmp(argv[opt], "--tablebase")))
+                        {
+                            opt++;
+                            tablebasePath = argv[opt] ? argv[opt] : "make7.tb";
+                            argTablebaseNotDone = false;
+                        }
+                        
+                        // Endgame tablebase to generate
+                        else if (argTablebaseNotDone && !(strcmp(argv[opt], "-E") && strcmp(argv[opt], "--build-tablebase")))
+                        {
+                            opt++;
+                            tablebasePlies = argv[opt] ? atoi(argv[opt]) : 1;
+                            
+                            if (argv[opt])
+                            {
+                                opt++;
+                            }
+                            
+                            tablebasePath = argv[opt] ? argv[opt] : "make7.tb";
+                            argTablebaseNotDone = false;
+                            
+                            if ((tablebasePlies < 1) || (tablebasePlies > MAKE7_AREA))
+                            {
+                                fprintf(stderr, "The tablebase must be from 1 to %d plies deep.\n", MAKE7_AREA);
+                                return 1;
+                            }
+                        }
+                        
+                        // Database of solved positions
+                        else if (argDatabaseNotDone && !(strcmp(argv[opt], "-D") && strcmp(argv[opt], "--database")))
+                        {
+                            opt++;
+                            databasePath = argv[opt] ? argv[opt] : "make7.db";
+                            argDatabaseNotDone = false;
+                        }
+                        
+                        // Opening book to probe
+                        else if (argBookNotDone && !(strcmp(argv[opt], "-o") && strcmp(argv[opt], "--book")))
+                        {
+                            opt++;
+                            bookPath = argv[opt] ? argv[opt] : "make7.bk";
+                            argBookNotDone = false;
+                        }
+                        
+                        // Opening book to build
+                        else if (argBookNotDone && !(strcmp(argv[opt], "-O") && strcmp(argv[opt], "--build-book")))
+                        {
+                            opt++;
+                            bookPlies = argv[opt] ? atoi(argv[opt]) : 1;
+                            
+                            if (argv[opt])
+                            {
+                                opt++;
+                            }
+                            
+                            bookPath = argv[opt] ? argv[opt] : "make7.bk";
+                            argBookNotDone = false;
+                            
+                            if ((bookPlies < 1) || (bookPlies > MAKE7_AREA))
+                            {
+                                fprintf(stderr, "The opening book must be from 1 to %d plies deep.\n", MAKE7_AREA);
+                                return 1;
+                            }
+                        }
+                        
+                        // Frontier pipeline
+                        else if (argFrontierNotDone && !(strcmp(argv[opt], "-F") && strcmp(argv[opt], "--frontier")))
+                        {
+                            opt++;
+                            frontierPlies = argv[opt] ? atoi(argv[opt]) : 1;
+                            
+                            if (argv[opt])
+                            {
+                                opt++;
+                            }
+                            
+                            frontierPath = argv[opt] ? argv[opt] : "make7.fr";
+                            argFrontierNotDone = false;
+                            
+                            if ((frontierPlies < 1) || (frontierPlies > MAKE7_AREA))
+                            {
+                                fprintf(stderr, "The frontier must be from 1 to %d plies deep.\n", MAKE7_AREA);
+                                return 1;
+                            }
+                        }
+                        
+                        // The slice of the frontier's work units to solve
+                        else if (argSliceNotDone && !(strcmp(argv[opt], "-S") && strcmp(argv[opt], "--slice")))
+                        {
+                            opt++;
+                            
+                            if (!argv[opt] || (sscanf(argv[opt], "%d/%d", &frontierSlice, &frontierSlices) != 2) || (frontierSlices < 1) || (frontierSlices > FRONTIER_SLICES) || (frontierSlice < 0) || (frontierSlice >= frontierSlices))
+                            {
+                                fprintf(stderr, "The slice must be given as K/N, with K from 0 to N - 1 and N from 1 to %d.\n", FRONTIER_SLICES);
+                                return 1;
+                            }
+                            
+                            argSliceNotDone = false;
+                        }
+                        
+                        // Checkpoints of a long solve
+                        else if (argCheckpointNotDone && !(strcmp(argv[opt], "-k") && strcmp(argv[opt], "--checkpoint")))
+                        {
+                            opt++;
+                            checkpointMinutes = argv[opt] ? atof(argv[opt]) : CK_INTERVAL;
+                            
+                            if (argv[opt])
+                            {
+                                opt++;
+                            }
+                            
+                            checkpointPath = argv[opt] ? argv[opt] : "make7.ck";
+                            argCheckpointNotDone = false;
+                            
+                            if (checkpointMinutes <= 0.0)
+                            {
+                                fprintf(stderr, "Checkpoints must be a positive number of minutes apart.\n");
+                                return 1;
+                            }
+                        }
+                        
+                        // Pick up from the last checkpoint
+                        else if (argResumeNotDone && !(strcmp(argv[opt], "-r") && strcmp(argv[opt], "--resume")))
+                        {
+                            resume = true;
+                            argResumeNotDone = false;
+                        }
+                        
                         // Parallelization
                         else if (argParallelNotDone && !(strcmp(argv[opt], "-p") && strcmp(argv[opt], "--parallel")))
                         {
@@ -136,6 +382,141 @@ int main(int argc, char **argv)
                             argParallelNotDone = false;
                         }
                         
+                        // Lazy SMP; mutually exclusive with root parallelization
+                        else if (argParallelNotDone && !(strcmp(argv[opt], "-l") && strcmp(argv[opt], "--lazy-smp")))
+                        {
+                            lazySMP = true;
+                            argParallelNotDone = false;
+                        }
+                        
+                        // Worker processes over a table in shared memory; mutually exclusive with the two above
+                        else if (argParallelNotDone && !(strcmp(argv[opt], "-P") && strcmp(argv[opt], "--processes")))
+                        {
+                            // A count is all digits, unlike a move sequence
+                            processes = (argv[opt + 1] && argv[opt + 1][0] && !argv[opt + 1][strspn(argv[opt + 1], "0123456789")]) ? atoi(argv[++opt]) : ThreadPool_processors();
+                            
+                            // Names of shared memory segments start with a slash, which tells them apart from a move sequence
+                            if (argv[opt + 1] && (argv[opt + 1][0] == '/'))
+                            {
+                                sharedName = argv[++opt];
+                            }
+                            
+                            argParallelNotDone = false;
+                            
+                            if (processes < 1)
+                            {
+                                fprintf(stderr, "There must be at least one worker process.\n");
+                                return 1;
+                            }
+                        }
+                        
+                        // Join the worker processes of another solve
+                        else if (argJoinNotDone && !(strcmp(argv[opt], "-J") && strcmp(argv[opt], "--join")))
+                        {
+                            if (argv[opt + 1] && (argv[opt + 1][0] == '/'))
+                            {
+                                sharedName = argv[++opt];
+                            }
+                            
+                            joining = true;
+                            argJoinNotDone = false;
+                        }
+                        
+                        // Answer queries on a socket
+                        else if (argServeNotDone && !(strcmp(argv[opt], "-u") && strcmp(argv[opt], "--serve")))
+                        {
+                            // A path is anything that does not look like a move sequence or another switch
+                            if (argv[opt + 1] && (argv[opt + 1][0] != '-') && !((argv[opt + 1][0] >= '1') && (argv[opt + 1][0] <= '3') && strchr("ABCDEFGabcdefg", argv[opt + 1][1]) && argv[opt + 1][1]))
+                            {
+                                servePath = argv[++opt];
+                            }
+                            else
+                            {
+                                servePath = SV_PATH;
+                            }
+                            
+                            argServeNotDone = false;
+                        }
+                        
+                        // Solve a file of positions
+                        else if (argBatchNotDone && !(strcmp(argv[opt], "-B") && strcmp(argv[opt], "--batch")))
+                        {
+                            // Standard input is read without a file, or with a lone dash
+                            batchPath = (argv[opt + 1] && ((argv[opt + 1][0] != '-') || !argv[opt + 1][1])) ? argv[++opt] : "-";
+                            
+                            if (argv[opt + 1] && !(strcmp(argv[opt + 1], "csv") && strcmp(argv[opt + 1], "jsonl") && strcmp(argv[opt + 1], "binary")))
+                            {
+                                opt++;
+                                batchFormat = !strcmp(argv[opt], "jsonl") ? BATCH_JSONL : !strcmp(argv[opt], "binary") ? BATCH_BINARY : BATCH_CSV;
+                            }
+                            
+                            argBatchNotDone = false;
+                        }
+                        
+                        // Annotate every ply of a game
+                        else if (argAnnotateNotDone && !(strcmp(argv[opt], "-A") && strcmp(argv[opt], "--annotate")))
+                        {
+                            annotate = true;
+                            argAnnotateNotDone = false;
+                        }
+                        
+                        // Pin the worker threads to processors
+                        else if (argPinNotDone && !(strcmp(argv[opt], "-a") && strcmp(argv[opt], "--pin")))
+                        {
+                            // A list of processors is digits, commas and dashes, unlike a move sequence; without one, every processor we may run on is used
+                            if (argv[opt + 1] && (argv[opt + 1][0] >= '0') && (argv[opt + 1][0] <= '9') && !argv[opt + 1][strspn(argv[opt + 1], "0123456789,-")])
+                            {
+                                pinCount = Numa_cpus(argv[++opt], pinned);
+                            }
+                            else if (!(pinCount = Numa_allowed(pinned)))
+                            {
+                                for (pinCount = 0; (pinCount < ThreadPool_processors()) && (pinCount < NUMA_BITS); pinCount++)
+                                {
+                                    pinned[pinCount] = pinCount;
+                                }
+                            }
+                            
+                            argPinNotDone = false;
+                            
+                            if (!pinCount)
+                            {
+                                fprintf(stderr, "There must be at least one processor to pin the worker threads to.\n");
+                                return 1;
+                            }
+                        }
+                        
+                        // Keep the priority we were started with
+                        else if (argPriorityNotDone && !(strcmp(argv[opt], "-n") && strcmp(argv[opt], "--normal-priority")))
+                        {
+                            normalPriority = true;
+                            argPriorityNotDone = false;
+                        }
+                        
+                        // Stop the parallel solve once the best move is proven
+                        else if (argBestNotDone && !(strcmp(argv[opt], "-b") && strcmp(argv[opt], "--best-move")))
+                        {
+                            bestOnly = true;
+                            argBestNotDone = false;
+                        }
+                        
+                        // Time limit for an anytime solve
+                        else if (argTimeNotDone && !(strcmp(argv[opt], "-T") && strcmp(argv[opt], "--time-limit")))
+                        {
+                            opt++;
+                            limits.seconds = argv[opt] ? atof(argv[opt]) : 1.0;
+                            limited = true;
+                            argTimeNotDone = false;
+                        }
+                        
+                        // Node limit for an anytime solve
+                        else if (argNodeNotDone && !(strcmp(argv[opt], "-N") && strcmp(argv[opt], "--node-limit")))
+                        {
+                            opt++;
+                            limits.nodes = argv[opt] ? strtoull(argv[opt], nullptr, 10) : 1000000;
+                            limited = true;
+                            argNodeNotDone = false;
+                        }
+                        
                         // Tile color swapping
                         else if (argSwapNotDone && !(strcmp(argv[opt], "-s") && strcmp(argv[opt], "--swap-colors")))
                         {
@@ -176,6 +557,16 @@ int main(int argc, char **argv)
         }
     }
     
+    // Lower our priority for other processes
+    if (!normalPriority)
+    {
+#if defined(_WIN64) || defined(_WIN32)
+        SetPriorityClass(GetCurrentProcess(), IDLE_PRIORITY_CLASS);
+#elifdef __linux__
+        setpriority(PRIO_PROCESS, getpid(), 19);
+#endif
+    }
+    
     if (!monteCarloTS)
     {
         if (notFixedTable)
@@ -195,12 +586,12 @@ int main(int argc, char **argv)
                 for (power2 = 1; power2 < gigs; power2 <<= 1);
                 
                 // Keep asking for memory but use half of that memory if unable to get it reserved
-                while (power2 && !TransTable_initialize(&table, (finalTTSize = TT_HASHSIZE * power2)))
+                while (power2 && !TransTable_initialize(&solver.table, (finalTTSize = TT_HASHSIZE * power2)))
                 {
                     power2 >>= 1;
                 }
                 
-                if (!table.entry)
+                if (!solver.table.entry)
                 {
                     fprintf(stderr, "Could not initialize the transposition table size to the installed memory size.\n");
                     exit(EXIT_FAILURE);
@@ -208,7 +599,7 @@ int main(int argc, char **argv)
             }
             else // Use a fallback if cannot get system information3
             {
-                TransTable_initialize(&table, (finalTTSize = TT_HASHSIZE));
+                TransTable_initialize(&solver.table, (finalTTSize = TT_HASHSIZE));
             }
             
 #elif defined(_WIN64) || defined(_WIN32) // Windows: get host memory size using GlobalMemoryStatusEx; this works with virtual machines unlike GetPhysicallyInstalledSystemMemory
@@ -241,25 +632,25 @@ int main(int argc, char **argv)
             // If either succeeded, initialize transposition table with half of host memory
             if (success0)
             {
-                for (upower2 >>= 1; upower2 && !TransTable_initialize(&table, (finalTTSize = TT_HASHSIZE * upower2)); upower2 >>= 1);
+                for (upower2 >>= 1; upower2 && !TransTable_initialize(&solver.table, (finalTTSize = TT_HASHSIZE * upower2)); upower2 >>= 1);
             }
             else if (success1)
             {
-                for (power2 >>= 1; upower2 && !TransTable_initialize(&table, (finalTTSize = TT_HASHSIZE * power2)); power2 >>= 1);
+                for (power2 >>= 1; upower2 && !TransTable_initialize(&solver.table, (finalTTSize = TT_HASHSIZE * power2)); power2 >>= 1);
             }
             else // When neither of the above worked, use a gigabyte
             {
-                TransTable_initialize(&table, (finalTTSize = TT_HASHSIZE));
+                TransTable_initialize(&solver.table, (finalTTSize = TT_HASHSIZE));
             }
 #else
             // Default to one gigabyte on all other platforms
-            TransTable_initialize(&table, (finalTTSize = TT_HASHSIZE));
+            TransTable_initialize(&solver.table, (finalTTSize = TT_HASHSIZE));
 #endif
         }
-        else if (!interactive)
+        else if (!interactive || limited) // Interactive play only needs a table for the minimax player
         {
             // Use a fixed size for the transposition table
-            if (!TransTable_initialize(&table, finalTTSize * (TT_HASHSIZE >> 1)))
+            if (!TransTable_initialize(&solver.table, finalTTSize * (TT_HASHSIZE >> 1)))
             {
                 fprintf(stderr, "Could not allocate memory for the transposition table. Please try a different size.\n"); 
                 return 1;
@@ -273,14 +664,421 @@ int main(int argc, char **argv)
     // For parallelized negamax, each thread will have its own transposition table, so there is no need to allocate a global one
     if (parallel)
     {
-        TransTable_destroy(&table);
+        TransTable_destroy(&solver.table);
     }
     
+    // The table every thread probes is spread over the NUMA nodes before anything is written to it
+    Numa_interleave(solver.table.entry, solver.table.size * sizeof(*solver.table.entry));
+    
     // Seed the Mersenne Twister PRNG
     init_genrand(time(nullptr) + clock());
+    
+    // Start the worker threads once; both engines queue their work on them. Pinned, there is one per processor given
+    if (!ThreadPool_initialize(&pool, pinCount ? pinCount : ThreadPool_processors(), pinCount ? pinned : nullptr))
+    {
+        fprintf(stderr, "Could not start the worker threads.\n");
+        return 1;
+    }
+    
+    // This thread searches alongside the workers in Lazy SMP and Monte Carlo tree search; tied to one worker's processor, it would share that core while another sits idle
+    if (pinCount && !Numa_pinAny(pinned, pinCount))
+    {
+        fprintf(stderr, "Could not keep this thread on the processors the workers are pinned to.\n");
+    }
+    
+    // Every pool worker and this thread count their own nodes
+    if (!NegamaxContext_initialize(&solver, &pool))
+    {
+        fprintf(stderr, "Could not allocate the node counters.\n");
+        return 1;
+    }
+    
+    solver.bestOnly = bestOnly;
+    
+    // Proof-number search takes over the memory sized for the transposition table
+    if (proofNumber && !monteCarloTS && !interactive)
+    {
+        if (!DfpnContext_initialize(&prover, &pool, solver.table.size * sizeof(TT_Entry) / sizeof(PT_Entry)))
+        {
+            fprintf(stderr, "Could not allocate memory for the proof-number table. Please try a different size.\n");
+            return 1;
+        }
+        
+        TransTable_destroy(&solver.table);
+    }
+    
+    MCTSContext_initialize(&mcts, &pool);
      
-    // Prepare alpha-beta move ordering array
-    Negamax_setColMoveOrder();
+    // Prepare alpha-beta move ordering array for this thread
+    NegamaxThread_initialize(&mainThread, &solver, &solver.table, 0);
+    
+    // Generate the endgame tablebase of the position given, save it, and quit
+    if (tablebasePlies)
+    {
+        if (!solver.table.entry)
+        {
+            fprintf(stderr, "Generating a tablebase needs the shared transposition table; please leave out -p, -d and -m.\n");
+            return 1;
+        }
+        
+        Make7_initialize(&ms);
+        
+        if (argSeq[0] && !Make7_sequence(&ms, argSeq))
+        {
+            fprintf(stderr, "Could not play the move sequence \"%s\".\n", argSeq);
+            return 1;
+        }
+        
+        if (!Tablebase_generate(&endgame, &solver, &ms, tablebasePlies, true) || !Tablebase_save(&endgame, tablebasePath))
+        {
+            fprintf(stderr, "Could not generate the tablebase to \"%s\".\n", tablebasePath);
+            return 1;
+        }
+        
+        printf("Wrote %llu positions to \"%s\"\n", (unsigned long long)endgame.count, tablebasePath);
+        ThreadPool_destroy(&pool);
+        NegamaxContext_destroy(&solver);
+        Tablebase_destroy(&endgame);
+        
+        return 0;
+    }
+    
+    // Both engines probe the endgame tablebase, if one was given
+    if (tablebasePath)
+    {
+        if (!Tablebase_load(&endgame, tablebasePath))
+        {
+            fprintf(stderr, "Could not load the tablebase \"%s\".\n", tablebasePath);
+            return 1;
+        }
+        
+        solver.tablebase = mcts.tablebase = &endgame;
+    }
+    
+    // Earlier solves are looked up at the root and throughout the search, and every new one is added
+    if (databasePath)
+    {
+        if (!Database_open(&solved, databasePath))
+        {
+            fprintf(stderr, "Could not open the database \"%s\".\n", databasePath);
+            return 1;
+        }
+        
+        solver.database = &solved;
+    }
+    
+    // Build the opening book of the position given, save it, and quit; every position gets the budget of -T or -N, a second if neither is given
+    if (bookPlies)
+    {
+        if (!solver.table.entry)
+        {
+            fprintf(stderr, "Building an opening book needs the shared transposition table; please leave out -p, -d and -m.\n");
+            return 1;
+        }
+        
+        Make7_initialize(&ms);
+        
+        if (argSeq[0] && !Make7_sequence(&ms, argSeq))
+        {
+            fprintf(stderr, "Could not play the move sequence \"%s\".\n", argSeq);
+            return 1;
+        }
+        
+        if (!Book_build(&openings, &mainThread, &mcts, &ms, bookPlies, (limits.nodes || limits.seconds) ? limits : (NegamaxLimits) {0, 1.0}) || !Book_save(&openings, bookPath))
+        {
+            fprintf(stderr, "Could not build the opening book to \"%s\".\n", bookPath);
+            return 1;
+        }
+        
+        printf("Wrote %llu positions to \"%s\"\n", (unsigned long long)openings.count, bookPath);
+        ThreadPool_destroy(&pool);
+        NegamaxContext_destroy(&solver);
+        Tablebase_destroy(&endgame);
+        Book_destroy(&openings);
+        
+        if (solver.database)
+        {
+            Database_close(&solved);
+        }
+        
+        return 0;
+    }
+    
+    // Run the frontier pipeline of the position given, report what it backed up, and quit; -T and -N limit every work unit
+    if (frontierPlies)
+    {
+        if (!solver.table.entry)
+        {
+            fprintf(stderr, "The frontier pipeline needs the shared transposition table; please leave out -p, -d and -m.\n");
+            return 1;
+        }
+        
+        Make7_initialize(&ms);
+        
+        if (argSeq[0] && !Make7_sequence(&ms, argSeq))
+        {
+            fprintf(stderr, "Could not play the move sequence \"%s\".\n", argSeq);
+            return 1;
+        }
+        
+        if (!Frontier_run(&solver, &ms, frontierPlies, frontierPath, frontierSlice, frontierSlices, limits, &r, r1, r2, r3))
+        {
+            fprintf(stderr, "The frontier pipeline in \"%s\" stopped before it was done.\n", frontierPath);
+            return 1;
+        }
+        
+        // A slice backs up what every slice has solved so far; the root stays unknown until enough of them are done
+        (r.wdl == UNKNOWN_CHAR) ? printf("%c ", UNKNOWN_CHAR) : (r.wdl == DRAW_CHAR) ? printf("%s ", DRAW_TEXT) : Result_print(&r, &r);
+        puts("");
+        
+        for (uint8_t tile = 1; tile <= 3; tile++)
+        {
+            printf("%d ", tile);
+            
+            for (uint8_t col = 0; col < MAKE7_SIZE; col++)
+            {
+                Result_print(tile == 1 ? &r1[col] : tile == 2 ? &r2[col] : &r3[col], &r);
+            }
+            
+            puts("");
+        }
+        
+        ThreadPool_destroy(&pool);
+        NegamaxContext_destroy(&solver);
+        Tablebase_destroy(&endgame);
+        
+        if (solver.database)
+        {
+            Database_close(&solved);
+        }
+        
+        return 0;
+    }
+    
+    // Solve the root moves another process queues in its shared table until it is done, then quit
+    if (joining)
+    {
+        TransTable_destroy(&solver.table);
+        
+        if (!Shared_open(&shared, sharedName, 0, false))
+        {
+            fprintf(stderr, "Could not join the shared table \"%s\".\n", sharedName);
+            return 1;
+        }
+        
+        Shared_work(&shared, &solver, true);
+        Shared_close(&shared, false);
+        ThreadPool_destroy(&pool);
+        NegamaxContext_destroy(&solver);
+        Tablebase_destroy(&endgame);
+        
+        if (solver.database)
+        {
+            Database_close(&solved);
+        }
+        
+        return 0;
+    }
+    
+    // Both engines play from the opening book before searching, if one was given
+    if (bookPath && !Book_load(&openings, bookPath))
+    {
+        fprintf(stderr, "Could not load the opening book \"%s\".\n", bookPath);
+        return 1;
+    }
+    
+    // Answer queries on a socket until terminated; the table, book, database and threads set up above stay warm between them
+    if (servePath)
+    {
+        if (interactive || monteCarloTS || proofNumber || processes || checkpointPath || resume)
+        {
+            fprintf(stderr, "The server only answers with minimax solves in this process; please leave out -i, -m, -d, -P, -k and -r.\n");
+            return 1;
+        }
+        
+        // Budgeted queries search the shared table, which root parallelization gave up
+        if (parallel && limited)
+        {
+            fprintf(stderr, "The server answers budgeted queries from the shared transposition table; please leave out -p or -T and -N.\n");
+            return 1;
+        }
+        
+        // Ctrl-C ends the server and removes its socket instead of cutting a budgeted query short
+        solver.console = false;
+        server = (Server) {.thread = &mainThread, .book = &openings, .database = solver.database ? &solved : nullptr, .limits = limits, .limited = limited, .parallel = parallel, .lazySMP = lazySMP};
+        
+        if (!Server_open(&server, servePath))
+        {
+            fprintf(stderr, "Could not listen on the socket \"%s\".\n", servePath);
+            return 1;
+        }
+        
+        printf("Listening on \"%s\"\n", servePath);
+        fflush(stdout);
+        Server_run(&server);
+        Server_close(&server);
+        ThreadPool_destroy(&pool);
+        NegamaxContext_destroy(&solver);
+        Tablebase_destroy(&endgame);
+        Book_destroy(&openings);
+        
+        if (solver.database)
+        {
+            Database_close(&solved);
+        }
+        
+        return 0;
+    }
+    
+    // Solve every position of a file on every worker, write their answers to standard output, and quit
+    if (batchPath)
+    {
+        FILE *input;
+        bool success;
+        
+        if (interactive || monteCarloTS || proofNumber || processes || limited || checkpointPath || resume || servePath)
+        {
+            fprintf(stderr, "Batch mode only runs exact minimax solves; please leave out -i, -m, -d, -P, -T, -N, -k, -r and -u.\n");
+            return 1;
+        }
+        
+        if (!(input = strcmp(batchPath, "-") ? fopen(batchPath, "r") : stdin))
+        {
+            fprintf(stderr, "Could not open the positions \"%s\".\n", batchPath);
+            return 1;
+        }
+        
+        // With -p every worker gets a table of its own out of the memory the shared one was given
+        batch = (Batch) {.ctx = &solver, .book = &openings, .database = solver.database ? &solved : nullptr, .format = batchFormat};
+        clock_gettime(CLOCK_MONOTONIC, &parallelStart);
+        success = Batch_run(&batch, input, stdout, parallel);
+        clock_gettime(CLOCK_MONOTONIC, &parallelEnd);
+        sec = (double)((parallelEnd.tv_sec - parallelStart.tv_sec) + (parallelEnd.tv_nsec - parallelStart.tv_nsec) / 1000000000.0);
+        fprintf(stderr, "Solved %llu positions in %.3f seconds\n", (unsigned long long)batch.total, sec);
+        
+        if (input != stdin)
+        {
+            fclose(input);
+        }
+        
+        ThreadPool_destroy(&pool);
+        NegamaxContext_destroy(&solver);
+        Tablebase_destroy(&endgame);
+        Book_destroy(&openings);
+        
+        if (solver.database)
+        {
+            Database_close(&solved);
+        }
+        
+        if (!success)
+        {
+            fprintf(stderr, "Could not solve every position of \"%s\".\n", batchPath);
+            return 1;
+        }
+        
+        return 0;
+    }
+    
+    // Solve every position of one game from the last over the same table, write their values and marks, and quit
+    if (annotate)
+    {
+        char game[MAKE7_AREA_X2 + 3], *end;
+        
+        if (!solver.table.entry || interactive || monteCarloTS || proofNumber || processes || limited || checkpointPath || resume || servePath || batchPath)
+        {
+            fprintf(stderr, "Annotation only runs exact serial minimax solves over one table; please leave out -p, -i, -m, -d, -P, -T, -N, -k, -r, -u and -B.\n");
+            return 1;
+        }
+        
+        // Without a move sequence, the game is the first line of standard input
+        if (!argSeq[0])
+        {
+            game[0] = '\0';
+            
+            if (fgets(game, sizeof(game), stdin))
+            {
+                for (end = game + strlen(game); (end > game) && ((end[-1] == '\n') || (end[-1] == '\r') || (end[-1] == ' ')); *--end = '\0');
+            }
+        }
+        else
+        {
+            snprintf(game, sizeof(game), "%s", argSeq);
+        }
+        
+        annotation = (Annotation) {.thread = &mainThread, .book = &openings, .database = solver.database ? &solved : nullptr};
+        clock_gettime(CLOCK_MONOTONIC, &parallelStart);
+        
+        if (!Annotate_game(&annotation, game, true))
+        {
+            fprintf(stderr, "Could not play the move sequence \"%s\".\n", game);
+            return 1;
+        }
+        
+        clock_gettime(CLOCK_MONOTONIC, &parallelEnd);
+        sec = (double)((parallelEnd.tv_sec - parallelStart.tv_sec) + (parallelEnd.tv_nsec - parallelStart.tv_nsec) / 1000000000.0);
+        Annotate_print(&annotation, stdout);
+        fprintf(stderr, "Annotated %d plies in %.3f seconds\n", annotation.count + 1, sec);
+        ThreadPool_destroy(&pool);
+        NegamaxContext_destroy(&solver);
+        Tablebase_destroy(&endgame);
+        Book_destroy(&openings);
+        
+        if (solver.database)
+        {
+            Database_close(&solved);
+        }
+        
+        return 0;
+    }
+    
+    // The serial solve and its analysis write checkpoints of their table; resuming replaces the table with the last one written
+    if (checkpointPath || resume)
+    {
+        if (!solver.table.entry || lazySMP || limited || processes)
+        {
+            fprintf(stderr, "Checkpoints are only taken by the serial solve; please leave out -p, -l, -P, -d, -m, -T and -N.\n");
+            return 1;
+        }
+        
+        Checkpoint_initialize(&checkpoint, checkpointPath ? checkpointPath : "make7.ck", checkpointMinutes);
+        solver.checkpoint = &checkpoint;
+        
+        if (resume && !Checkpoint_restore(&checkpoint, &solver.table))
+        {
+            fprintf(stderr, "Could not resume from the checkpoint \"%s\".\n", checkpoint.path);
+            return 1;
+        }
+    }
+    
+    // The worker processes share a table in shared memory instead of the one allocated above; lines are followed through it too
+    if (processes)
+    {
+        size_t tableSize = solver.table.size;
+        
+        if (!solver.table.entry || interactive || proofNumber || monteCarloTS || limited)
+        {
+            fprintf(stderr, "Worker processes only run exact minimax solves; please leave out -i, -d, -m, -T and -N.\n");
+            return 1;
+        }
+        
+        TransTable_destroy(&solver.table);
+        
+        if (!Shared_open(&shared, sharedName, tableSize, true))
+        {
+            fprintf(stderr, "Could not set up the shared table \"%s\".\n", sharedName);
+            return 1;
+        }
+        
+        mainThread.table = &shared.table;
+    }
+    
+    // Root parallelization gave up the shared table, which a budgeted solve searches
+    if (parallel && limited && !monteCarloTS)
+    {
+        fprintf(stderr, "A budgeted solve searches the shared transposition table; please leave out -p or -T and -N.\n");
+        return 1;
+    }
     
     // Initialize the game with the starting position
     Make7_initialize(&ms);
@@ -389,12 +1187,25 @@ int main(int argc, char **argv)
                         }
                     }
                 }
+                else if (Book_probe(&openings, &ms, &best, &r))
+                {
+                    // Play the book move without thinking
+                    printf("%d%c\n", best >> 4, (best & 0x7) + 'A');
+                    Make7_drop(&ms, best >> 4, best & 0x7);
+                }
+                else if (limited && !monteCarloTS)
+                {
+                    // Play the best move minimax finds within the budget
+                    Negamax_solve_limited(&mainThread, &ms, limits, &best, false);
+                    printf("%d%c\n", best >> 4, (best & 0x7) + 'A');
+                    Make7_drop(&ms, best >> 4, best & 0x7);
+                }
                 else
                 {
 #if defined(_WIN64) || defined(_WIN32)
-                    mctsMove = MCTS_search(&ms, &handle, false);
+                    mctsMove = MCTS_search(&mcts, &ms, &handle, false);
 #else
-                    mctsMove = MCTS_search(&ms, nullptr, false);
+                    mctsMove = MCTS_search(&mcts, &ms, nullptr, false);
 #endif
                     Make7_drop(&ms, mctsMove >> 4, mctsMove & 0x7);
                     puts("");
@@ -420,15 +1231,25 @@ int main(int argc, char **argv)
             }
         }
         
+        ThreadPool_destroy(&pool);
+        NegamaxContext_destroy(&solver);
+        Tablebase_destroy(&endgame);
+        Book_destroy(&openings);
+        
+        if (solver.database)
+        {
+            Database_close(&solved);
+        }
+        
         return 0;
     }
     else
     {
         
 #if (defined(__MINGW32__) || defined(__MINGW64__)) // size_t is an unsigned long long in MinGW
-        monteCarloTS ? puts("Using Monte Carlo tree search") : printf("Transposition table of %llu entries\n", table.size);
+        monteCarloTS ? puts("Using Monte Carlo tree search") : proofNumber ? printf("Proof-number table of %llu entries\n", prover.table.size) : printf("Transposition table of %llu entries\n", solver.table.size);
 #else
-        monteCarloTS ? puts("Using Monte Carlo tree search") : printf("Transposition table of %lu entries\n", table.size);
+        monteCarloTS ? puts("Using Monte Carlo tree search") : proofNumber ? printf("Proof-number table of %lu entries\n", prover.table.size) : printf("Transposition table of %lu entries\n", solver.table.size);
 #endif
         
 #ifdef NO_SLIDERS
@@ -437,6 +1258,21 @@ int main(int argc, char **argv)
         puts("Utilizing sliding windows");
 #endif
         
+        if (solver.tablebase)
+        {
+            printf("Endgame tablebase of %llu positions from ply %u to %u\n", (unsigned long long)endgame.count, endgame.minPly, endgame.maxPly);
+        }
+        
+        if (solver.database)
+        {
+            printf("Database of %llu solved positions\n", (unsigned long long)solved.header->count);
+        }
+        
+        if (openings.count)
+        {
+            printf("Opening book of %llu positions\n", (unsigned long long)openings.count);
+        }
+        
         // Solving loop
         while (running)
         {       
@@ -447,14 +1283,16 @@ int main(int argc, char **argv)
             if (pgo)
             {
                 puts("Benchmarking Negamax...");
-                Negamax_search(&ms, &table, 16, -NM_WIN, NM_WIN);
-                TransTable_destroy(&table);
+                Negamax_search(&mainThread, &ms, 16, -NM_WIN, NM_WIN);
+                TransTable_destroy(&solver.table);
                 
                 puts("Benchmarking Monte Carlo...");
                 Make7_sequence(&ms, "2d2d2c2d3d1e2b1a2b2e1e");
-                MCTS_search(&ms, nullptr, false);
+                MCTS_search(&mcts, &ms, nullptr, false);
                 
                 puts("All benchmarks completed.");
+                ThreadPool_destroy(&pool);
+                NegamaxContext_destroy(&solver);
                 
                 return 0;
             }
@@ -531,42 +1369,98 @@ int main(int argc, char **argv)
                 continue;
             }
             
+            // The book answers a position in it at once; an exact solve only takes a proven result from it
+            if (Book_probe(&openings, &ms, &best, &r) && (monteCarloTS || limited || (r.wdl != UNKNOWN_CHAR)))
+            {
+                (r.wdl == UNKNOWN_CHAR) ? printf("%c ", UNKNOWN_CHAR) : (r.wdl == DRAW_CHAR) ? printf("%s ", DRAW_TEXT) : Result_print(&r, &r);
+                printf("\nBook: %d%c\n", (best >> 4), (best & 0b1111) + 'A');
+                Make7_initialize(&ms);
+                continue;
+            }
+            
             if (monteCarloTS)
             {
 #if defined(_WIN64) || defined(_WIN32)
-                parallel ? MCTS_rootParallel(&ms, &handle, true) : MCTS_search(&ms, &handle, true);
+                parallel ? MCTS_rootParallel(&mcts, &ms, &handle, true) : MCTS_search(&mcts, &ms, &handle, true);
 #else
-                parallel ? MCTS_rootParallel(&ms, nullptr, true) : MCTS_search(&ms, nullptr, true);
+                parallel ? MCTS_rootParallel(&mcts, &ms, nullptr, true) : MCTS_search(&mcts, &ms, nullptr, true);
 #endif
             }
             else
             {
                 // Time the search and print the solution, ensuring that the solution is valid for the game
-                atomic_store(&nodes, 0);
+                Negamax_resetNodes(&solver);
+                Dfpn_resetNodes(&prover);
                 
-                if (parallel)
+                // A position solved by an earlier run needs no search; a budgeted solve of a draw still searches for a move to play, as a draw has no line to follow
+                // The parallel solvers give the results of every move along the way, which the database does not keep, so they search whenever those are shown
+                if (solver.database && !proofNumber && !((parallel || processes) && !limited && !argSeq[0]) && Database_load(&solved, &ms, &r) && (!limited || (r.wdl != DRAW_CHAR)))
+                {
+                    sec = 0.0;
+                }
+                else if (proofNumber)
                 {
                     clock_gettime(CLOCK_MONOTONIC, &parallelStart);
-                    r = Negamax_solve_parallel(&ms, true, r1, r2, r3, nullptr, &best);
+                    r = Dfpn_solve(&prover, &ms, parallel, &best);
+                    clock_gettime(CLOCK_MONOTONIC, &parallelEnd);
+                    sec = (double)((parallelEnd.tv_sec - parallelStart.tv_sec) + (parallelEnd.tv_nsec - parallelStart.tv_nsec) / 1000000000.0);
+                }
+                else if (limited)
+                {
+                    clock_gettime(CLOCK_MONOTONIC, &parallelStart);
+                    r = Negamax_solve_limited(&mainThread, &ms, limits, &best, true);
+                    clock_gettime(CLOCK_MONOTONIC, &parallelEnd);
+                    sec = (double)((parallelEnd.tv_sec - parallelStart.tv_sec) + (parallelEnd.tv_nsec - parallelStart.tv_nsec) / 1000000000.0);
+                }
+                else if (processes)
+                {
+                    clock_gettime(CLOCK_MONOTONIC, &parallelStart);
+                    r = Shared_solve(&shared, &solver, &ms, processes, r1, r2, r3, &best);
+                    clock_gettime(CLOCK_MONOTONIC, &parallelEnd);
+                    sec = (double)((parallelEnd.tv_sec - parallelStart.tv_sec) + (parallelEnd.tv_nsec - parallelStart.tv_nsec) / 1000000000.0);
+                }
+                else if (parallel)
+                {
+                    clock_gettime(CLOCK_MONOTONIC, &parallelStart);
+                    r = Negamax_solve_parallel(&solver, &ms, true, r1, r2, r3, nullptr, &best);
+                    clock_gettime(CLOCK_MONOTONIC, &parallelEnd);
+                    sec = (double)((parallelEnd.tv_sec - parallelStart.tv_sec) + (parallelEnd.tv_nsec - parallelStart.tv_nsec) / 1000000000.0);
+                }
+                else if (lazySMP)
+                {
+                    clock_gettime(CLOCK_MONOTONIC, &parallelStart);
+                    r = Negamax_solve_lazy(&solver, &ms, true);
                     clock_gettime(CLOCK_MONOTONIC, &parallelEnd);
                     sec = (double)((parallelEnd.tv_sec - parallelStart.tv_sec) + (parallelEnd.tv_nsec - parallelStart.tv_nsec) / 1000000000.0);
                 }
                 else
                 {
                     stopwatch = clock();
-                    r = Negamax_solve(&ms, &table, true);
+                    r = Negamax_solve(&mainThread, &ms, true);
                     stopwatch = clock() - stopwatch;
                     sec = (double)(stopwatch) / CLOCKS_PER_SEC;
                 }
                 
-                npsec = (double)(atomic_load(&nodes)) / (sec ? sec : sec + 1.0);
+                // SIGTERM stopped the solve once its checkpoint was written
+                if (checkpoint.terminated)
+                {
+                    fprintf(stderr, "\nStopped; resume the solve from \"%s\" with -r.\n", checkpoint.path);
+                    break;
+                }
+                
+                npsec = (double)(proofNumber ? Dfpn_nodes(&prover) : Negamax_nodes(&solver)) / (sec ? sec : sec + 1.0);
                 assert((r.wdl == WIN_CHAR && !(r.dt7 & 1)) || (r.wdl == DRAW_CHAR) || (r.wdl == LOSS_CHAR && (r.dt7 & 1)) || (r.wdl == UNKNOWN_CHAR));
                 assert((oldMS.player[0] == ms.player[0]) && (oldMS.player[1] == ms.player[1]) && (oldMS.tiles23[0] == ms.tiles23[0]) && (oldMS.tiles23[1] == ms.tiles23[1]));
                 assert((oldMS.turn == ms.turn) && (oldMS.remaining[0] == ms.remaining[0]) && (oldMS.remaining[1] == ms.remaining[1]) && (oldMS.remaining[2] == ms.remaining[2]));
                 printf("\a");
                 
+                // The budget ran out before a proof; show how many plies are free of a forced result
+                if (r.wdl == UNKNOWN_CHAR)
+                {
+                    printf("%c%d ", UNKNOWN_CHAR, r.dt7);
+                }
 #if defined(_WIN64) || defined(_WIN32)
-                if (r.wdl == DRAW_CHAR)
+                else if (r.wdl == DRAW_CHAR)
                 {
                     SetConsoleTextAttribute(handle, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
                     printf("%s ", DRAW_TEXT);
@@ -577,14 +1471,45 @@ int main(int argc, char **argv)
                     Result_print(&r, &r);
                 }
 #else
-                (r.wdl == DRAW_CHAR) ? printf("\e[1;33m%s\e[0m ", DRAW_TEXT) : Result_print(&r, &r);
+                else
+                {
+                    (r.wdl == DRAW_CHAR) ? printf("\e[1;33m%s\e[0m ", DRAW_TEXT) : Result_print(&r, &r);
+                }
 #endif
-                printf("%llu %.0f %.3f\n", atomic_load(&nodes), npsec, sec);
+                printf("%llu %.0f %.3f\n", proofNumber ? Dfpn_nodes(&prover) : Negamax_nodes(&solver), npsec, sec);
                 
-                // Do not show the solutions for all the moves if ran with arguments
-                if (!argSeq[0])
+                // Print the optimal line in the same format as a move sequence; root parallelization keeps no table to follow it through
+                if (!parallel && !proofNumber && (pvLength = Negamax_principalVariation(&mainThread, &ms, r, pvLine)))
                 {
-                    if (parallel)
+                    printf("PV ");
+                    
+                    for (m = 0; m < pvLength; m++)
+                    {
+                        printf("%d%c", pvLine[m] >> 4, 'A' + (pvLine[m] & 0xf));
+                    }
+                    
+                    puts("");
+                }
+                else
+                {
+                    pvLength = 0;
+                }
+                
+                // Keep the result and its line for the next run; a proof's distance to 7 may not be the shortest, so it is not kept
+                if (solver.database && !proofNumber)
+                {
+                    Database_storeLine(&solved, &ms, r, pvLine, pvLength);
+                }
+                
+                // A budgeted solve only knows its best move so far, and a proof only its own; do not show the solutions for all the moves if ran with arguments
+                if (limited || proofNumber)
+                {
+                    best = pvLength ? pvLine[0] : best;
+                    printf("\aBest: %d%c\n", (best >> 4), (best & 0b1111) + 'A');
+                }
+                else if (!argSeq[0])
+                {
+                    if (parallel || processes)
                     {
                         printf("1 ");
                         
@@ -612,8 +1537,15 @@ int main(int argc, char **argv)
                     }
                     else
                     {
-                        Negamax_results(&ms, r1, r2, r3, &r);
-                        best = Result_getBestMove(r1, r2, r3);
+                        Negamax_results(&solver, &ms, r1, r2, r3, &r);
+                        
+                        if (checkpoint.terminated)
+                        {
+                            fprintf(stderr, "\nStopped; resume the analysis from \"%s\" with -r.\n", checkpoint.path);
+                            break;
+                        }
+                        
+                        best = pvLength ? pvLine[0] : Result_getBestMove(r1, r2, r3);
                     }
                     
                     printf("\aBest: %d%c\n", (best >> 4), (best & 0b1111) + 'A');
@@ -629,13 +1561,14 @@ int main(int argc, char **argv)
                 // Reset game and transposition table for another search
                 // Most optimizing compilers will make these following statments take constant time
                 // Compiling with MSVC, on the other hand, will not, slowing it down linearly
-                if (!parallel)
+                if (!parallel && !processes && !proofNumber)
                 {
-                    TransTable_destroy(&table);
+                    TransTable_destroy(&solver.table);
                     
                     if (running)
                     {
-                        TransTable_initialize(&table, table.size += 2);
+                        TransTable_initialize(&solver.table, solver.table.size += 2);
+                        Numa_interleave(solver.table.entry, solver.table.size * sizeof(*solver.table.entry));
                     }
                 }
             }
@@ -644,5 +1577,17 @@ int main(int argc, char **argv)
         }
     }
     
+    ThreadPool_destroy(&pool);
+    NegamaxContext_destroy(&solver);
+    DfpnContext_destroy(&prover);
+    Tablebase_destroy(&endgame);
+    Book_destroy(&openings);
+    Shared_close(&shared, processes);
+    
+    if (solver.database)
+    {
+        Database_close(&solved);
+    }
+    
     return 0;
 }
@@ -10,6 +10,7 @@ void Make7_initialize(Make7* restrict _m7)
     _m7->remaining[0] = _m7->remaining[1] = 0xbb;
     _m7->remaining[2] = 0x44;
     _m7->turn = false;
+    _m7->lastTile = 0;
     g_inputReadyFlag = 0;
     
     for (int i = 0; i < MAKE7_SIZE; i++)
@@ -539,6 +540,28 @@ bool Make7_sequence(Make7* restrict _m7, const char* restrict _SEQ)
     return true;
 }
 
+int Make7_moves(Make7* restrict _m7, const char* restrict _SEQ, uint8_t* restrict _moves)
+{
+    uint8_t tile, col;
+    int count;
+    
+    // A tile and a column after another, in either case, with nothing in between
+    for (count = 0; _SEQ[0]; _SEQ += 2)
+    {
+        tile = _SEQ[0] - '0';
+        col = (_SEQ[1] & ~0x20) - 'A';
+        
+        if (!_SEQ[1] || (tile < 1) || (tile > 3) || (col >= MAKE7_SIZE) || Make7_gameOver(_m7) || !Make7_drop(_m7, tile, col))
+        {
+            return -1;
+        }
+        
+        _moves[count++] = (tile << 4) | col;
+    }
+    
+    return count;
+}
+
 inline uint64_t Make7_hashEncode(const Make7* restrict _M7)
 {
     return _M7->player[_M7->turn] + _M7->player[0] + _M7->player[1] + MAKE7_BOT;
@@ -558,6 +581,15 @@ uint64_t Make7_reverse(uint64_t _grid)
 
 bool Make7_symmetrical(const Make7* restrict _M7)
 {
+    // Cheap rejection first; mirror images have mirrored column heights
+    for (uint8_t col = 0; col < (MAKE7_SIZE >> 1); col++)
+    {
+        if (_M7->height[col] - MAKE7_SIZE_P1 * col != _M7->height[MAKE7_SIZE_M1 - col] - MAKE7_SIZE_P1 * (MAKE7_SIZE_M1 - col))
+        {
+            return false;
+        }
+    }
+    
     uint64_t revTiles[4] = {_M7->player[0], _M7->player[1], _M7->tiles23[0], _M7->tiles23[1]};
     
     // Reverse player tiles and number tiles
@@ -679,6 +711,48 @@ bool Make7_checkFor7(const Make7* restrict _M7)
     return false;
 }
 
+uint64_t Make7_threats(const Make7* restrict _M7, const bool _PLAYER)
+{
+    uint64_t avail12Mask = ((_M7->player[0] | _M7->player[1]) + MAKE7_BOT) & MAKE7_ALL;
+    uint64_t avail3Mask = avail12Mask & MAKE7_THREES, threatMask = 0;
+    
+    // Look at the grid as if it were the given player's turn
+    Make7 threatM7 = *_M7;
+    threatM7.turn = _PLAYER;
+    
+    Make7 checkM7 = threatM7;
+    
+    while (avail12Mask)
+    {
+        uint64_t tileMask = avail12Mask & -avail12Mask;
+        
+#if (defined(__MINGW32__) || defined(__MINGW64__))
+        uint8_t column = __builtin_ctzll(tileMask) >> 3;
+#else
+        uint8_t column = stdc_trailing_zeros(tileMask) >> 3;
+#endif
+        
+        // One tile that makes 7 is enough; Make7_drop refuses tiles the player has run out of
+        for (uint8_t tile = 1; (tile <= 3) && !(threatMask & tileMask); tile++)
+        {
+            if (((tile < 3) || (avail3Mask & tileMask)) && Make7_drop(&checkM7, tile, column))
+            {
+                if (Make7_tilesSumTo7(&checkM7))
+                {
+                    threatMask |= tileMask;
+                }
+                
+                checkM7 = threatM7;
+            }
+        }
+        
+        avail12Mask &= ~tileMask;
+        avail3Mask &= ~tileMask;
+    }
+    
+    return threatMask;
+}
+
 void Make7_helpMessage(const char* restrict _NAME)
 {
     printf("Usage: %s <switch> [ARGS]\n\n", _NAME);
@@ -695,12 +769,99 @@ void Make7_helpMessage(const char* restrict _NAME)
     puts(" -h -? --help\t\tDisplays this help message and exit.\n");
     puts(" -i --interactive\tAllows the user to play interactively. They can play");
     puts("\t\t\tagainst the Monte Carlo tree search AI or an additional");
-    puts("\t\t\thuman player. It is impossible to play against the");
-    puts("\t\t\tminimax AI at this time.\n");
+    puts("\t\t\thuman player. Give a time or node limit to play against");
+    puts("\t\t\tthe minimax AI instead.\n");
     printf(" -m --mcts\t\tUses Monte Carlo tree search instead of minimax to solve");
     puts("\n\t\t\tthe game. Cancel anytime by hitting Ctrl+C.\n");
+    puts(" -d --dfpn\t\tSolves with depth-first proof-number search instead of");
+    puts("\t\t\titerative deepening. It finds deep forced wins faster,");
+    puts("\t\t\tbut the distance to 7 is that of the proof it found,");
+    puts("\t\t\twhich may not be the shortest. Combine with -p to run");
+    puts("\t\t\tthe proof on every thread over one shared table.\n");
+    puts(" -e --tablebase [FILE]\tProbes the endgame tablebase in [FILE] while solving.");
+    puts("\t\t\tPositions in it are known at once, and Monte Carlo");
+    puts("\t\t\ttree search simulations end when they reach one.\n");
+    puts(" -E --build-tablebase [PLIES] [FILE]");
+    puts("\t\t\tGenerates an endgame tablebase of every position up to");
+    puts("\t\t\t[PLIES] plies after the move sequence, and writes it to");
+    puts("\t\t\t[FILE]. The deepest positions are solved by minimax on");
+    puts("\t\t\tevery thread; the rest are worked out backwards from");
+    puts("\t\t\tthem. Keep [PLIES] small; the positions multiply fast.\n");
+    puts(" -D --database [FILE]\tKeeps the results of every solve in [FILE] and looks");
+    puts("\t\t\tthem up in later runs, so positions solved before are");
+    puts("\t\t\tanswered at once. It is created if it does not exist.\n");
+    puts(" -o --book [FILE]\tPlays the moves of the opening book in [FILE] without");
+    puts("\t\t\tsearching, both when solving and in interactive play.\n");
+    puts(" -O --build-book [PLIES] [FILE]");
+    puts("\t\t\tBuilds an opening book of every position in the first");
+    puts("\t\t\t[PLIES] plies after the move sequence, and writes it to");
+    puts("\t\t\t[FILE]. Each position is solved by minimax within the");
+    puts("\t\t\tlimits of -T or -N, a second if neither is given. If");
+    puts("\t\t\tthat proves nothing, Monte Carlo tree search picks the");
+    puts("\t\t\tmove in four times as long.\n");
+    puts(" -F --frontier [PLIES] [DIR]");
+    puts("\t\t\tSolves the position in pieces: every position [PLIES]");
+    puts("\t\t\tplies after the move sequence becomes a work unit in");
+    puts("\t\t\t[DIR], solved by one worker process per thread. Every");
+    puts("\t\t\tresult is saved as soon as it is known, and a run that");
+    puts("\t\t\tstopped carries on where it left off. -T and -N limit");
+    puts("\t\t\teach unit; those over it are tried again the next run.\n");
+    puts(" -S --slice [K/N]\tSolves only the [K]th of [N] slices of the units of -F,");
+    puts("\t\t\tin this process, to spread them over many machines that");
+    puts("\t\t\tshare [DIR]. A final run without it backs them up.\n");
+    puts(" -k --checkpoint [MIN] [FILE]");
+    puts("\t\t\tWrites the transposition table and the progress of the");
+    puts("\t\t\tsolve to [FILE] every [MIN] minutes, and once more when");
+    puts("\t\t\tterminated by SIGTERM, before stopping. Only the serial");
+    puts("\t\t\tsolve and its analysis of every move take checkpoints.\n");
+    puts(" -r --resume\t\tPicks the solve up from the last checkpoint; give the");
+    puts("\t\t\tsame position again. The table keeps the size it had.\n");
     puts(" -p --parallel\t\tParallelizes the search at the root position. This is");
     puts("\t\t\texperimental and may not work properly in every case.\n");
+    puts(" -l --lazy-smp\t\tSolves with every thread searching the same root and");
+    puts("\t\t\tsharing one transposition table (Lazy SMP) instead of");
+    puts("\t\t\tsplitting the root moves between threads.\n");
+    puts(" -P --processes [N] [NAME]");
+    puts("\t\t\tSolves the root moves in [N] worker processes, one per");
+    puts("\t\t\tprocessor by default, over one transposition table in");
+    puts("\t\t\tthe shared memory segment [NAME]. A worker that dies");
+    puts("\t\t\tis started again, and its move is handed to another.\n");
+    puts(" -J --join [NAME]\tJoins the worker processes of a solve started with -P");
+    puts("\t\t\ton the segment [NAME], until that solve is over. Start");
+    puts("\t\t\tit under numactl to bind it to a NUMA node.\n");
+    puts(" -u --serve [PATH]\tAnswers queries on the Unix domain socket [PATH] instead");
+    puts("\t\t\tof reading standard input, keeping the table, book and");
+    puts("\t\t\tthreads between them. Send a move sequence on a line to");
+    puts("\t\t\tget its result and best move back; put a + in front of");
+    puts("\t\t\tit to get the result of every move as well. Add -D to");
+    puts("\t\t\tanswer positions asked for before at once.\n");
+    puts(" -B --batch [FILE] [FORMAT]");
+    puts("\t\t\tSolves every move sequence in [FILE], one per line, or");
+    puts("\t\t\tfrom standard input, on every thread over one shared");
+    puts("\t\t\ttable; add -p to give each thread its own. The result,");
+    puts("\t\t\tbest move and node count of each are written in order");
+    puts("\t\t\tas csv (the default), jsonl or binary records.\n");
+    puts(" -A --annotate\t\tSolves every position of the game given as the move");
+    puts("\t\t\tsequence, or read from standard input, from the last one");
+    puts("\t\t\tback over one table, then writes the value of each ply");
+    puts("\t\t\tand of the move played there, marking blunders ?? and");
+    puts("\t\t\tslower wins or quicker losses ?.\n");
+    puts(" -a --pin [CPUS]\tPins a worker thread to each processor in the list");
+    puts("\t\t\t[CPUS], such as 0-3,8, so that none moves between cores");
+    puts("\t\t\tand loses what it had in their caches. Without a list,");
+    puts("\t\t\tevery processor the solver may run on gets a worker.\n");
+    puts(" -n --normal-priority\tKeeps the priority the solver was started with instead");
+    puts("\t\t\tof lowering it to the idle priority, for timings that");
+    puts("\t\t\tother programs do not disturb.\n");
+    puts(" -b --best-move\t\tStops the parallel search as soon as the best move is");
+    puts("\t\t\tproven. The other moves are reported as unknown.\n");
+    puts(" -N --node-limit [N]\tStops solving after [N] positions and reports the");
+    puts("\t\t\tbest move found so far along with the number of plies");
+    puts("\t\t\tthat are free of a forced result. Without a proof, the");
+    puts("\t\t\tmove is picked by a heuristic evaluation of the grid.\n");
+    puts(" -T --time-limit [SEC]\tStops solving after [SEC] seconds, as above. Both");
+    puts("\t\t\tlimits may be given; whichever runs out first applies.");
+    puts("\t\t\tCancel anytime by hitting Ctrl+C.\n");
     puts(" -s --swap-colors\tSwaps the colors of the tiles. Instead of Green going");
     puts("\t\t\tfirst, Yellow will be going first.\n");
     printf(" -t --table-size [SIZE]\tModifies the transposition table entry size to [SIZE]");
@@ -60,11 +60,11 @@
 #define MAKE7_P1_NAME "Green"
 #define MAKE7_P2_NAME "Yellow"
 
-// Global temporary storage locations or buffers for the number tiles from user input.
-static uint8_t g_userNumberTile, g_inputReadyFlag;
+// Temporary storage locations or buffers for the number tiles from user input, one per thread.
+static thread_local uint8_t g_userNumberTile, g_inputReadyFlag;
 
 // Whether to swap the tile colors in the output.
-static bool g_swapColors;
+[[maybe_unused]] static bool g_swapColors;
 
 // Vertical bitmask table to search for vertical connections below this tile, including itself
 static const uint64_t VERT_BITMASK_TABLE[55] = {0x1ull, 0x3ull, 0x7ull, 0xfull, 0x1full, 0x3full, 0x7full, 0x0ull,
@@ -129,6 +129,7 @@ bool Make7_gameOver(const Make7*);                              // Tests if the
 bool Make7_noMoreMoves(const Make7*);                           // True when the current player to move has no more legal moves and false otherwise.
 uint8_t Make7_plyNum(const Make7*);                             // Counts the number of plies or half-moves using population count.
 bool Make7_gridFull(const Make7*);                              // Another draw condition is when the grid becomes full if either player has tiles left.
+uint64_t Make7_threats(const Make7*, const bool);               // Returns the playable squares where the given player makes 7 with a tile they have left.
 
 // Move functions
 bool Make7_drop(Make7*, const uint8_t, const uint8_t);          // Drops a number tile to a column as long as that column is not full.
@@ -137,6 +138,7 @@ bool Make7_drop(Make7*, const uint8_t, const uint8_t);          // Drops a numbe
 // User input functions
 bool Make7_getUserInput(Make7*, const char);                    // Performs a move from user input. Numbers specify what tile to use and letters what column to drop.
 bool Make7_sequence(Make7*, const char*);                       // Perform moves from a string of characters. This is used when the user chooses to pass them as arguments.
+int Make7_moves(Make7*, const char*, uint8_t*);                 // Strictly plays a move sequence and keeps its moves, tile in the upper four bits; their number, or -1 if it is not one.
 
 // Other functions
 uint64_t Make7_hashEncode(const Make7*);                        // Encodes a hashed Make 7 position for use in the transposition table.
@@ -3,12 +3,28 @@
 */
 
 #include "mcts.h"
+#include "tablebase.h"
 
-// Toggle the run flag to stop after receiving SIGINT
+// Toggle the run flag of the active search to stop after receiving SIGINT
 static inline void MCTS_stop(int UNUSED)
 {
     (void)(UNUSED); // To suppress the unused parameter warning
-    atomic_store(&runMCTS, false);
+    atomic_bool *run = atomic_load(&mctsInterrupt);
+    
+    if (run)
+    {
+        atomic_store(run, false);
+    }
+}
+
+void MCTSContext_initialize(MCTSContext* restrict _ctx, ThreadPool* restrict _pool)
+{
+    _ctx->pool = _pool;
+    _ctx->tablebase = nullptr;
+    _ctx->seconds = 0.0;
+    _ctx->result = (MCTSResult) {0.0, 0, 0};
+    _ctx->console = true;
+    atomic_init(&_ctx->run, true);
 }
 
 /*!
@@ -217,18 +233,31 @@ bool MCTS_expand(MCTSNode* restrict _expander, const Make7* restrict _M7)
 }
 
 /*!
+ *  @param _TB      The endgame tablebase to end the simulation early in, or null.
  *  @param _simulMS The Make 7 game state to simulate.
  *  @param _TURN    Who's turn it is to play.
  *  @return         The reward for the simulation.
  */
-signed long long MCTS_simulate(Make7* restrict _simulMS, const uint8_t _TURN)
+signed long long MCTS_simulate(const Tablebase* restrict _TB, Make7* restrict _simulMS, const uint8_t _TURN)
 {
     unsigned randMove;
     uint8_t simulMoves[MAKE7_SIZE_X3], simulCount;
+    Result tableResult;
     
     // Play until the game is over
     for (;;)
     {
+        // The rest of the game is known once the tablebase has the position; the player to move wins, loses, or draws with perfect play
+        if (_TB && Tablebase_probe(_TB, _simulMS, &tableResult))
+        {
+            if (tableResult.wdl == DRAW_CHAR)
+            {
+                return 0;
+            }
+            
+            return ((tableResult.wdl == WIN_CHAR) ^ (_TURN != _simulMS->turn)) ? -1 : 1;
+        }
+        
         // Get the list of possible drops to simulate
         Make7_generate(_simulMS, simulMoves, &simulCount);
         
@@ -270,7 +299,7 @@ void MCTS_backpropagate(MCTSNode* restrict _backpropagator, signed long long _si
 
 /*!
  *  @param _root The root MCTS node to search from.
- *  @return      The move with the highest visits and odds of winning.
+ *  @return      The move with the highest visits and odds of winning, or no move if the root was never expanded.
  */
 MCTSResult MCTS_best(MCTSNode* restrict _root)
 {
@@ -279,6 +308,12 @@ MCTSResult MCTS_best(MCTSNode* restrict _root)
     unsigned long long bestVisits;
     uint8_t node, bestState, descLosses, descDraws, descUnsolved;
     
+    // A search stopped before its first iteration has nothing to choose from
+    if (!_root->count)
+    {
+        return (MCTSResult) {0.0, 0, MCTS_UNSOLVED};
+    }
+    
     // Count the number of unsolved, lost, and drawn descendants
     for (node = descLosses = descDraws = descUnsolved = 0; node < _root->count && !descLosses; node++)
     {
@@ -381,7 +416,7 @@ int ProgressThread_print(void *_args)
     {
         thrd_sleep(&oneSec, nullptr);
         
-        if (atomic_load(&runMCTS) && progress->output && progress->root->state == MCTS_UNSOLVED)
+        if (atomic_load(progress->run) && progress->output && progress->root->state == MCTS_UNSOLVED)
         {
             *progress->result = MCTS_best(progress->root);
             MCTS_progress(progress->result, progress->winConHandle, *(progress->iters), ++(*progress->seconds), progress->root->state);
@@ -396,12 +431,13 @@ int ProgressThread_print(void *_args)
 }
 
 /*!
+ *  @param _ctx      The search context holding the tree, the thread pool, and the run flag.
  *  @param _M7       The Make 7 game state to search for a move.
  *  @param _WIN_HND  The handle to the console window (compilation for Windows only).
  *  @param _OUTPUT   Whether to output the search progress to the console.
  *  @return          The best move found by Monte Carlo tree search.
  */
-uint8_t MCTS_search(const Make7* restrict _M7, void* restrict _WIN_HND, const bool _OUTPUT)
+uint8_t MCTS_search(MCTSContext* restrict _ctx, const Make7* restrict _M7, void* restrict _WIN_HND, const bool _OUTPUT)
 {
     
 #if defined(_WIN64) || defined(_WIN32)
@@ -410,14 +446,13 @@ uint8_t MCTS_search(const Make7* restrict _M7, void* restrict _WIN_HND, const bo
     (void)(_WIN_HND);
 #endif
     
-    static MCTSNode root, *leaf;
-    static MCTSResult result;
+    MCTSNode *leaf;
     
     double oneTile[MAKE7_SIZE], twoTile[MAKE7_SIZE], threeTile[MAKE7_SIZE];
     long long i, secs, sims;
     uint8_t tile, col, state1[MAKE7_SIZE], state2[MAKE7_SIZE], state3[MAKE7_SIZE];
     ProgressThread progThread;
-    thrd_t ioThread;
+    struct timespec start, now;
     
     Make7 mctsM7 = *_M7;
     
@@ -479,10 +514,11 @@ uint8_t MCTS_search(const Make7* restrict _M7, void* restrict _WIN_HND, const bo
         }
     }*/
     
-    progThread = (ProgressThread) {.root = &root,
-                                   .result = &result,
+    progThread = (ProgressThread) {.root = &_ctx->root,
+                                   .result = &_ctx->result,
                                    .iters = &i,
                                    .seconds = &secs,
+                                   .run = &_ctx->run,
                                    .output = _OUTPUT};
 
 #if defined(_WIN64) || defined(_WIN32)
@@ -491,26 +527,38 @@ uint8_t MCTS_search(const Make7* restrict _M7, void* restrict _WIN_HND, const bo
     progThread.winConHandle = nullptr;
 #endif
     
-    switch (thrd_create(&ioThread, ProgressThread_print, &progThread))
+    // Report the progress from a pool worker while this thread searches; a quiet search would only wait a second for it at the end
+    if (_OUTPUT)
     {
-    case thrd_nomem:
-        printf("Ran out of memory creating simulation thread #%lld.\n", i);
-        exit(EXIT_FAILURE);
-    case thrd_error:
-        printf("Could not create simulation thread #%lld.\n", i);
-        exit(EXIT_FAILURE);
-    default:
-        break;
+        ThreadPool_submit(_ctx->pool, ProgressThread_print, &progThread);
     }
     
     // Catch SIGINT to stop the search
-    signal(SIGINT, MCTS_stop);
-    MCTSNode_initialize(&root, nullptr, 0);
+    if (_ctx->console)
+    {
+        atomic_store(&mctsInterrupt, &_ctx->run);
+        signal(SIGINT, MCTS_stop);
+    }
+    
+    MCTSNode_initialize(&_ctx->root, nullptr, 0);
+    clock_gettime(CLOCK_MONOTONIC, &start);
     
-    for (i = secs = 0; atomic_load(&runMCTS) && root.state == MCTS_UNSOLVED; i++)
+    for (i = secs = 0; atomic_load(&_ctx->run) && _ctx->root.state == MCTS_UNSOLVED; i++)
     {
+        // A timed search stops on its own once the time is up, as if Ctrl+C was hit; the progress task waits for the same flag
+        if (_ctx->seconds && !(i & MCTS_LIMIT_INTERVAL))
+        {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            
+            if ((now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1000000000.0 >= _ctx->seconds)
+            {
+                atomic_store(&_ctx->run, false);
+                break;
+            }
+        }
+        
         // Selection
-        leaf = MCTS_select(&root, &mctsM7);
+        leaf = MCTS_select(&_ctx->root, &mctsM7);
         
         // Expansion
         if (!MCTS_expand(leaf, &mctsM7))
@@ -525,7 +573,7 @@ uint8_t MCTS_search(const Make7* restrict _M7, void* restrict _WIN_HND, const bo
         {
             leaf = &leaf->descendant[genrand_int32() % leaf->count];
             Make7_drop(&mctsM7, leaf->move >> 4, leaf->move & 0xf);
-            sims = MCTS_simulate(&mctsM7, mctsM7.turn);
+            sims = MCTS_simulate(_ctx->tablebase, &mctsM7, mctsM7.turn);
             
             /*// Copy the game state to the threads
             for (tid = 0; tid < numThreads; tid++)
@@ -572,12 +620,12 @@ uint8_t MCTS_search(const Make7* restrict _M7, void* restrict _WIN_HND, const bo
         // Compute best move found and print the progress
         /*if ((elapsed = difftime(time(nullptr), progress)) >= 1)
         {
-            result = MCTS_best(&root);
+            _ctx->result = MCTS_best(&_ctx->root);
             
 #if defined(_WIN64) || defined(_WIN32)
-            MCTS_progress(&result, winTerm, i, ++secs, root.state);
+            MCTS_progress(&_ctx->result, winTerm, i, ++secs, _ctx->root.state);
 #else
-            MCTS_progress(&result, nullptr, i, ++secs, root.state);
+            MCTS_progress(&_ctx->result, nullptr, i, ++secs, _ctx->root.state);
 #endif
             
             progress = time(nullptr);
@@ -585,21 +633,25 @@ uint8_t MCTS_search(const Make7* restrict _M7, void* restrict _WIN_HND, const bo
     }
     
     // Get the best move by average points per visit
-    result = MCTS_best(&root);
-    printf("\a");
+    _ctx->result = MCTS_best(&_ctx->root);
+    
+    if (_ctx->console)
+    {
+        printf("\a");
+    }
     
     if (_OUTPUT)
     {
-        if (root.state != MCTS_UNSOLVED)
+        if (_ctx->root.state != MCTS_UNSOLVED)
         {
 #ifdef _WIN64
-            MCTS_progress(&result, winTerm, i, !secs ? 1 : secs, root.state);
+            MCTS_progress(&_ctx->result, winTerm, i, !secs ? 1 : secs, _ctx->root.state);
 #else
-            MCTS_progress(&result, nullptr, i, !secs ? 1 : secs, root.state);
+            MCTS_progress(&_ctx->result, nullptr, i, !secs ? 1 : secs, _ctx->root.state);
 #endif
         }
         
-        //root.state != MCTS_UNSOLVED ? NodeStatus_print(root.state, false) : puts("");
+        //_ctx->root.state != MCTS_UNSOLVED ? NodeStatus_print(_ctx->root.state, false) : puts("");
         puts("");
         
         // Initialize the array of points for invalid moves
@@ -610,24 +662,24 @@ uint8_t MCTS_search(const Make7* restrict _M7, void* restrict _WIN_HND, const bo
         }
         
         // Copy the points to the array
-        for (i = 0; i < root.count; i++)
+        for (i = 0; i < _ctx->root.count; i++)
         {
-            tile = root.descendant[i].move >> 4;
-            col = root.descendant[i].move & 0xf;
+            tile = _ctx->root.descendant[i].move >> 4;
+            col = _ctx->root.descendant[i].move & 0xf;
             
             switch (tile)
             {
             case 1:
-                oneTile[col] = (double)(root.descendant[i].points) / root.descendant[i].visits;
-                state1[col] = root.descendant[i].state;
+                oneTile[col] = (double)(_ctx->root.descendant[i].points) / _ctx->root.descendant[i].visits;
+                state1[col] = _ctx->root.descendant[i].state;
                 break;
             case 2:
-                twoTile[col] = (double)(root.descendant[i].points) / root.descendant[i].visits;
-                state2[col] = root.descendant[i].state;
+                twoTile[col] = (double)(_ctx->root.descendant[i].points) / _ctx->root.descendant[i].visits;
+                state2[col] = _ctx->root.descendant[i].state;
                 break;
             case 3:
-                threeTile[col] = (double)(root.descendant[i].points) / root.descendant[i].visits;
-                state3[col] = root.descendant[i].state;
+                threeTile[col] = (double)(_ctx->root.descendant[i].points) / _ctx->root.descendant[i].visits;
+                state3[col] = _ctx->root.descendant[i].state;
                 break;
             }
         }
@@ -638,7 +690,7 @@ uint8_t MCTS_search(const Make7* restrict _M7, void* restrict _WIN_HND, const bo
 #else
         MCTS_pointStats(nullptr, oneTile, twoTile, threeTile, state1, state2, state3);
 #endif
-        // MCTSNode_avgPoints(&root);
+        // MCTSNode_avgPoints(&_ctx->root);
     }
     
     /*for (i = 0; i < numThreads; i++)
@@ -650,21 +702,22 @@ uint8_t MCTS_search(const Make7* restrict _M7, void* restrict _WIN_HND, const bo
         }
     }*/
     
-    if (thrd_join(ioThread, nullptr) == thrd_error)
+    ThreadPool_wait(_ctx->pool);
+    
+    if (_ctx->console)
     {
-        puts("Could not join the I/O thread");
-        exit(EXIT_FAILURE);
+        signal(SIGINT, SIG_DFL);
+        atomic_store(&mctsInterrupt, nullptr);
     }
     
-    signal(SIGINT, SIG_DFL);
-    MCTSNode_destroy(&root);
+    MCTSNode_destroy(&_ctx->root);
     /*Barrier_destroy(&simulStart);
     Barrier_destroy(&simulEnd);
     free(simulators);
     free(simulArgs);*/
-    atomic_store(&runMCTS, true);
+    atomic_store(&_ctx->run, true);
     
-    return result.bestMove;
+    return _ctx->result.bestMove;
 }
 
 void MCTS_progress(const MCTSResult* restrict _RESULT, void* restrict _WIN_HND, const unsigned long long _ITERS, const unsigned long long _SECS, const uint8_t _STATE)
@@ -1036,7 +1089,7 @@ int MCTS_rootWorker(void *_args)
     init_genrand(time(nullptr) + clock() + mrt->id);
     
     // Run until the user stops us
-    while (atomic_load(&runMCTS))
+    while (atomic_load(mrt->run))
     {
         // Select
         leaf = MCTS_select(&mrt->localRoot, &mrt->copyM7);
@@ -1045,7 +1098,7 @@ int MCTS_rootWorker(void *_args)
         if (!MCTS_expand(leaf, &mrt->copyM7))
         {
             // On insufficient memory, stop the thread
-            atomic_store(&runMCTS, false);
+            atomic_store(mrt->run, false);
             return 1;
         }
         
@@ -1057,7 +1110,7 @@ int MCTS_rootWorker(void *_args)
         }
         
         // Simulate and backpropagate
-        localSim = Make7_tilesSumTo7(&mrt->copyM7) ? MAKE7_AREA_P1 - Make7_plyNum(&mrt->copyM7) : MCTS_simulate(&mrt->copyM7, mrt->copyM7.turn);
+        localSim = Make7_tilesSumTo7(&mrt->copyM7) ? MAKE7_AREA_P1 - Make7_plyNum(&mrt->copyM7) : MCTS_simulate(mrt->tablebase, &mrt->copyM7, mrt->copyM7.turn);
         MCTS_backpropagate(leaf, localSim);
         
         // Reset the local game state for another iteration
@@ -1086,29 +1139,32 @@ void MCTSNode_update(MCTSNode* restrict _global, MCTSNode* restrict _local, cons
     }
 }
 
-uint8_t MCTS_rootParallel(Make7* restrict _M7, void* restrict _WIN_HND, const bool _OUTPUT)
+uint8_t MCTS_rootParallel(MCTSContext* restrict _ctx, Make7* restrict _M7, void* restrict _WIN_HND, const bool _OUTPUT)
 {
 #if defined(_WIN64) || defined(_WIN32)
     HANDLE *winTerm = _WIN_HND;
-    thrCount = GetMaximumProcessorCount(ALL_PROCESSOR_GROUPS);
-#elifdef __unix__
+#else
     (void)(_WIN_HND);
-    thrCount = sysconf(_SC_NPROCESSORS_ONLN);
 #endif
     
-    thrd_t mctsThreads[thrCount];
-    MCTSRootThread thrArgs[thrCount];
-    MCTSNode thrLRoots[thrCount], *bestRoot;
+    // One search per pool worker; the calling thread only reports progress
+    MCTSRootThread thrArgs[_ctx->pool->count];
+    MCTSNode thrLRoots[_ctx->pool->count], *bestRoot;
     MCTSResult thrBestRes;
     mtx_t rootLock;
     double gOneTile[MAKE7_SIZE], gTwoTile[MAKE7_SIZE], gThreeTile[MAKE7_SIZE];
     atomic_ullong i;
     unsigned long long secs, currVis, bestVis;
     struct timespec printTime;
-    int thr, thrRet, tile, col;
+    int thr, tile, col;
     uint8_t mvCount, list[MAKE7_SIZE_X3];
     
-    signal(SIGINT, MCTS_stop);
+    if (_ctx->console)
+    {
+        atomic_store(&mctsInterrupt, &_ctx->run);
+        signal(SIGINT, MCTS_stop);
+    }
+    
     Make7_generate(_M7, list, &mvCount);
     atomic_init(&i, 0);
     printTime.tv_sec = 1;
@@ -1129,8 +1185,8 @@ uint8_t MCTS_rootParallel(Make7* restrict _M7, void* restrict _WIN_HND, const bo
         exit(EXIT_FAILURE);
     }
     
-    // Initialize thread arguments and create the threads
-    for (thr = 0; thr < thrCount; thr++)
+    // Initialize worker arguments and queue the searches
+    for (thr = 0; thr < _ctx->pool->count; thr++)
     {
         MCTSNode_initialize(&thrLRoots[thr], nullptr, 0);
         
@@ -1142,32 +1198,24 @@ uint8_t MCTS_rootParallel(Make7* restrict _M7, void* restrict _WIN_HND, const bo
             .globalRoot = thrGRoot,
             .gRootLock = &rootLock,
             .iters = &i,
+            .run = &_ctx->run,
+            .tablebase = _ctx->tablebase,
             .id = thr,
             .totalGMoves = mvCount
         };
         
-        switch (thrd_create(&mctsThreads[thr], MCTS_rootWorker, &thrArgs[thr]))
-        {
-        case thrd_nomem:
-            fprintf(stderr, "Ran out of memory while creating thread #%d.\n", thr);
-            exit(EXIT_FAILURE);
-        case thrd_error:
-            fprintf(stderr, "Could not create thread #%d for root parallelization.\n", thr);
-            exit(EXIT_FAILURE);
-        default:
-            break;
-        }
+        ThreadPool_submit(_ctx->pool, MCTS_rootWorker, &thrArgs[thr]);
     }
     
     // Print the progress of the search every second until the user interrupts
-    while (atomic_load(&runMCTS))
+    while (atomic_load(&_ctx->run))
     {
         thrd_sleep(&printTime, nullptr);
         mtx_lock(&rootLock);
         bestRoot = &thrGRoot[0];
         bestVis = currVis = bestRoot->visits;
         
-        for (thr = 1; thr < thrCount; thr++)
+        for (thr = 1; thr < mvCount; thr++)
         {
             if ((currVis = thrGRoot[thr].visits) > bestVis)
             {
@@ -1188,19 +1236,12 @@ uint8_t MCTS_rootParallel(Make7* restrict _M7, void* restrict _WIN_HND, const bo
     
     }
     
-    // Join the threads after completing the search
-    for (thr = 0; thr < thrCount; thr++)
+    // Wait for the workers to see the stop flag, then free their trees
+    ThreadPool_wait(_ctx->pool);
+    
+    for (thr = 0; thr < _ctx->pool->count; thr++)
     {
-        switch (thrd_join(mctsThreads[thr], &thrRet))
-        {
-        case thrd_error:
-            fprintf(stderr, "Could not join thread #%d after completing Monte Carlo tree search.\n", thr);
-            exit(EXIT_FAILURE);
-        default:
-            break;
-        }
-        
-        MCTSNode_destroy(&thrLRoots[thr]);
+        MCTSNode_destroy(&thrArgs[thr].localRoot);
     }
     
     if (_OUTPUT)
@@ -1238,8 +1279,13 @@ uint8_t MCTS_rootParallel(Make7* restrict _M7, void* restrict _WIN_HND, const bo
 #endif
     }
 
-    signal(SIGINT, SIG_DFL);
-    atomic_store(&runMCTS, true);
+    if (_ctx->console)
+    {
+        signal(SIGINT, SIG_DFL);
+        atomic_store(&mctsInterrupt, nullptr);
+    }
+    
+    atomic_store(&_ctx->run, true);
     mtx_destroy(&rootLock);
     
     return thrBestRes.bestMove;
@@ -9,6 +9,7 @@
     This implementation uses a points-based reward system than a naive win-rate statistic, encouraging a stronger level of play.
     Wins are worth +1 point, losses -1 point, and draws 0 points. Immediate wins or losses are worth one plus the game grid's area minus the depth.
     It is still not immune to shallow traps; a good short-term strategy becomes a bad long-term strategy; this is a weakness of random sampling.
+    A loaded endgame tablebase softens this: a simulation that reaches a position in it ends there with the exact result instead of playing on at random.
     
     Despite the weaknesses of Monte Carlo tree search, it is still a very useful for three reasons:
     - Best suited for games with large branching factors where traditional minimax becomes impractical to use.
@@ -32,14 +33,15 @@
 #include <stddef.h>
 
 #include "make7.h"
+#include "pool.h"
 
 // sqrt(2) is a good balance between exploration and exploitation
 // smalller = more exploitation; larger = more exploration
 #define MCTS_UCT_C 1.41421356237309504880168872420969807856967187537694807317667973799073247846210703885l
 #define MCTS_INVALID -1000.0l // Random invalid value
 
-// Flag to run the search via Ctrl-C
-static atomic_bool runMCTS = true;
+// How often a timed search checks the clock, as a mask on its iteration count
+#define MCTS_LIMIT_INTERVAL 0x3ff
 
 // The data structure housing a Monte Carlo tree search node
 // The game is not stored to reduce memory footprint when running for long periods
@@ -62,6 +64,22 @@ typedef struct
 }
 MCTSResult;
 
+// Everything a Monte Carlo tree search needs; separate contexts can search side by side in one process
+typedef struct
+{
+    MCTSNode root;
+    MCTSResult result;
+    ThreadPool *pool;
+    const struct Tablebase *tablebase;
+    double seconds;
+    atomic_bool run;
+    bool console;                                                       // Ctrl-C stops the search and the bell rings at its end; off when embedded in another program
+}
+MCTSContext;
+
+// The run flag of the search that Ctrl-C stops; a signal handler cannot be handed a context of its own
+static _Atomic(atomic_bool*) mctsInterrupt;
+
 // MCTSNode solved status
 typedef enum
 {
@@ -77,6 +95,8 @@ typedef struct
     Make7 *originM7;
     mtx_t *gRootLock;
     atomic_ullong *iters;
+    atomic_bool *run;
+    const struct Tablebase *tablebase;
     int id;
     uint8_t totalGMoves;
 }
@@ -98,12 +118,14 @@ typedef struct
     MCTSNode *root;
     MCTSResult *result;
     long long *iters, *seconds;
+    atomic_bool *run;
     void **winConHandle;
     bool output;
 }
 ProgressThread;
 
 // Memory management
+void MCTSContext_initialize(MCTSContext*, ThreadPool*);                                                         // Set up a search context on a thread pool
 void MCTSNode_initialize(MCTSNode*, MCTSNode*, const uint8_t);                                                  // Initialize a Monte Carlo tree search node
 void MCTSNode_destroy(MCTSNode*);                                                                               // Recursively release memory from it and its descendants
 
@@ -116,17 +138,17 @@ void MCTSNode_avgPoints(const MCTSNode*);
 double MCTS_uct(const MCTSNode*);                                                                          // Compute the upper confidence bound for trees
 MCTSNode *MCTS_select(MCTSNode*, Make7*);                                                                       // Select the best node to expand
 bool MCTS_expand(MCTSNode*, const Make7*);                                                                      // Expand the selected node for every move
-signed long long MCTS_simulate(Make7*, const uint8_t);                                                          // Simulate a random game from the current state
+signed long long MCTS_simulate(const struct Tablebase*, Make7*, const uint8_t);                                 // Simulate a random game from the current state
 void MCTS_backpropagate(MCTSNode*, signed long long);                                                           // Backpropagate the result of the simulation
 MCTSResult MCTS_best(MCTSNode*);                                                                                // Return the best move from the root node
-uint8_t MCTS_search(const Make7*, void*, const bool);                                                           // Entry point for the Monte Carlo tree search algorithm
+uint8_t MCTS_search(MCTSContext*, const Make7*, void*, const bool);                                            // Entry point for the Monte Carlo tree search algorithm
 void MCTS_progress(const MCTSResult*, void*, const unsigned long long, const unsigned long long, const uint8_t);               // Write the Monte Carlo tree search progress to stdout
 void MCTS_pointStats(void*, const double*, const double*, const double*, const uint8_t*, const uint8_t*, const uint8_t*);                        // Display the cumulative point statistics for each move
 
 // Multi-threading
 void MCTSNode_update(MCTSNode*, MCTSNode*, const uint8_t);                                                      // Update the global root node's statistics
 int MCTS_rootWorker(void*);                                                                                     // Main function for the Monte Carlo tree search worker
-uint8_t MCTS_rootParallel(Make7*, void*, const bool);                                                           // Run the algorithm in parallel at the root node
+uint8_t MCTS_rootParallel(MCTSContext*, Make7*, void*, const bool);                                            // Run the algorithm in parallel at the root node
 
 void NodeStatus_print(const NodeStatus, const bool);
 
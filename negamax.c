@@ -3,22 +3,223 @@
 */
 
 #include "negamax.h"
+#include "tablebase.h"
+#include "database.h"
+#include "checkpoint.h"
 
-void Negamax_setColMoveOrder(void)
+// Toggle the stop flag of the active budgeted solve to play its move now after receiving SIGINT
+static inline void Negamax_interrupt(int UNUSED)
+{
+    (void)(UNUSED); // To suppress the unused parameter warning
+    atomic_bool *stop = atomic_load(&negamaxInterrupt);
+    
+    if (stop)
+    {
+        atomic_store(stop, true);
+    }
+}
+
+// Read the monotonic clock in nanoseconds
+static inline unsigned long long Negamax_clock(void)
+{
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+// Count the squares set on a bitboard
+static inline int Negamax_popcount(const uint64_t _BB)
+{
+#if (defined(__MINGW32__) || defined(__MINGW64__))
+    return __builtin_popcountll(_BB);
+#else
+    return stdc_count_ones(_BB);
+#endif
+}
+
+bool NegamaxContext_initialize(NegamaxContext* restrict _ctx, ThreadPool* restrict _pool)
+{
+    // The calling thread counts at index 0, pool workers after it
+    _ctx->pool = _pool;
+    _ctx->counterCount = _pool->count + 1;
+    _ctx->nodeCap = _ctx->deadline = 0;
+    _ctx->bestOnly = _ctx->limited = _ctx->evaluate = false;
+    _ctx->console = true;
+    _ctx->tablebase = nullptr;
+    _ctx->database = nullptr;
+    _ctx->checkpoint = nullptr;
+    atomic_init(&_ctx->stop, false);
+    atomic_init(&_ctx->horizon, INT_MAX);
+    
+    return (_ctx->counters = calloc(_ctx->counterCount, sizeof(*_ctx->counters)));
+}
+
+void NegamaxContext_destroy(NegamaxContext* restrict _ctx)
+{
+    free(_ctx->counters);
+    _ctx->counters = nullptr;
+    _ctx->counterCount = 0;
+    TransTable_destroy(&_ctx->table);
+}
+
+void NegamaxThread_initialize(NegamaxThread* restrict _nt, NegamaxContext* restrict _ctx, TransTable* restrict _tt, const int _ID)
+{
+    _nt->ctx = _ctx;
+    _nt->table = _tt;
+    _nt->rootDepth = 0;
+    
+    // The counter belongs to whichever thread calls this, so it must be the thread that searches
+    _nt->nodes = &_ctx->counters[poolWorkerID + 1].count;
+    
+    if (_ID)
+    {
+        Negamax_shuffleColMoveOrder(_nt->moveOrder, _ID);
+    }
+    else
+    {
+        Negamax_setColMoveOrder(_nt->moveOrder);
+    }
+}
+
+unsigned long long Negamax_nodes(const NegamaxContext* restrict _CTX)
+{
+    unsigned long long total = 0;
+    
+    for (int i = 0; i < _CTX->counterCount; i++)
+    {
+        total += atomic_load_explicit(&_CTX->counters[i].count, memory_order_relaxed);
+    }
+    
+    return total;
+}
+
+void Negamax_resetNodes(NegamaxContext* restrict _ctx)
+{
+    for (int i = 0; i < _ctx->counterCount; i++)
+    {
+        atomic_store_explicit(&_ctx->counters[i].count, 0, memory_order_relaxed);
+    }
+}
+
+void Negamax_checkLimits(NegamaxContext* restrict _ctx)
+{
+    if ((_ctx->nodeCap && (Negamax_nodes(_ctx) >= _ctx->nodeCap)) || (_ctx->deadline && (Negamax_clock() >= _ctx->deadline)))
+    {
+        atomic_store(&_ctx->stop, true);
+    }
+}
+
+void Negamax_setColMoveOrder(int* restrict _order)
 {
     for (int i = 0; i < MAKE7_SIZE; i++) // Center to outermost
     {
-        moveOrder[i] = (MAKE7_SIZE >> 1) + (1 - 2 * (i & 1)) * ((i + 1) >> 1);
+        _order[i] = (MAKE7_SIZE >> 1) + (1 - 2 * (i & 1)) * ((i + 1) >> 1);
+    }
+}
+
+void Negamax_shuffleColMoveOrder(int* restrict _order, const int _ID)
+{
+    int i, swap;
+    
+    Negamax_setColMoveOrder(_order);
+    
+    // Odd helpers visit the right column of each pair first
+    for (i = 1; (_ID & 1) && (i < MAKE7_SIZE); i += 2)
+    {
+        swap = _order[i];
+        _order[i] = _order[i + 1];
+        _order[i + 1] = swap;
+    }
+    
+    // Every other pair of helpers tries the columns next to the center before the center itself
+    if (_ID & 2)
+    {
+        swap = _order[0];
+        _order[0] = _order[1];
+        _order[1] = swap;
     }
 }
 
-int Negamax_search(const Make7* restrict _M7, TransTable* restrict _tt, const int  _D, int _a, int _b)
+int Negamax_evaluate(const Make7* restrict _M7)
+{
+    static const uint8_t DIRECTION[] = { 1, MAKE7_SIZE, MAKE7_SIZE_P1, MAKE7_SIZE_P2 }; // Vertical and the three lines across the grid
+    uint64_t empty = MAKE7_ALL & ~(_M7->player[0] | _M7->player[1]), own, open, live, first, second, third, threats;
+    int score[2] = { 0, 0 };
+    
+    for (uint8_t p = 0; p < 2; p++)
+    {
+        own = _M7->player[p];
+        open = own | empty;
+        
+        // Every run that sums to 7 covers three squares in a row; count those the opponent has not blocked yet, keyed by their lowest square
+        for (uint8_t dir = 0; dir < sizeof(DIRECTION); dir++)
+        {
+            live = open & (open >> DIRECTION[dir]) & (open >> (DIRECTION[dir] << 1));
+            first = own;
+            second = own >> DIRECTION[dir];
+            third = own >> (DIRECTION[dir] << 1);
+            
+            score[p] += NM_EVAL_LIVE * Negamax_popcount(live & (first | second | third));
+            score[p] += NM_EVAL_DOUBLE * Negamax_popcount(live & ((first & second) | (second & third) | (first & third)));
+        }
+        
+        // Squares where the player makes 7 with a tile still in hand; the opponent can only block one of them per turn
+        threats = Make7_threats(_M7, p);
+        score[p] += NM_EVAL_THREAT * Negamax_popcount(threats);
+        
+        if ((p != _M7->turn) && (threats & (threats - 1)))
+        {
+            score[p] += NM_EVAL_FORK;
+        }
+        
+        // Tiles left in hand are chances to make 7 later, the rarer 3s more so
+        score[p] += ((_M7->remaining[1] >> (p << 2)) & 0xf) + (((_M7->remaining[2] >> (p << 2)) & 0xf) << 1);
+    }
+    
+    return score[_M7->turn] - score[!_M7->turn];
+}
+
+int Negamax_known(const Result _RESULT, const int _D)
+{
+    // A win or loss beyond the remaining depth still counts as a draw here, as it would had it been searched
+    if ((_RESULT.wdl == DRAW_CHAR) || (_RESULT.dt7 > _D))
+    {
+        return NM_DRAW;
+    }
+    
+    return (_RESULT.wdl == WIN_CHAR) ? NM_WIN : -NM_WIN;
+}
+
+int Negamax_search(NegamaxThread* restrict _nt, const Make7* restrict _M7, const int  _D, int _a, int _b)
 {    
-    // Increment the number of game tree nodes searched
-    atomic_fetch_add(&nodes, 1);
+    int tableScore;
+    unsigned long long nodes = atomic_load_explicit(_nt->nodes, memory_order_relaxed) + 1;
+    
+    // Increment the number of game tree nodes searched; only this thread writes its counter, so it needs no locked instruction
+    atomic_store_explicit(_nt->nodes, nodes, memory_order_relaxed);
+    
+    // Every few thousand nodes, see if a budgeted solve has run out
+    if (!(nodes & NM_LIMIT_INTERVAL) && _nt->ctx->limited)
+    {
+        Negamax_checkLimits(_nt->ctx);
+    }
+    
+    // As often, see if a checkpoint is due
+    if (!(nodes & NM_LIMIT_INTERVAL) && _nt->ctx->checkpoint)
+    {
+        Checkpoint_poll(_nt->ctx->checkpoint, _nt);
+    }
+    
+    // Unwind without touching the table if another thread asked us to stop, or if this iteration can no longer improve the result
+    if (atomic_load_explicit(&_nt->ctx->stop, memory_order_relaxed) || (_nt->rootDepth >= atomic_load_explicit(&_nt->ctx->horizon, memory_order_relaxed)))
+    {
+        return NM_DRAW;
+    }
     
     // See if the score is in the transposition table
-    if ((tableScore = TransTable_load(_tt, Make7_hashEncode(_M7), _M7->tiles23[0], _M7->tiles23[1])))
+    if ((tableScore = TransTable_load(_nt->table, Make7_hashEncode(_M7), _M7->tiles23[0], _M7->tiles23[1], _D)))
     {
         return tableScore;
     }
@@ -29,33 +230,60 @@ int Negamax_search(const Make7* restrict _M7, TransTable* restrict _tt, const in
         return NM_WIN; // The current player wins
     }
     
-    // Check if the player cannot make any more moves or hiting maxiumum depth
-    if (!_D || Make7_noMoreMoves(_M7))
+    // Check if the player cannot make any more moves
+    if (Make7_noMoreMoves(_M7))
+    {
+        return NM_DRAW;
+    }
+    
+    Result knownResult;
+    
+    // The tablebase or an earlier solve knows this position for certain
+    if ((_nt->ctx->tablebase && Tablebase_probe(_nt->ctx->tablebase, _M7, &knownResult)) || (_nt->ctx->database && Database_load(_nt->ctx->database, _M7, &knownResult)))
     {
-        return NM_DRAW; // Assume a draw
+        return Negamax_known(knownResult, _D);
+    }
+    
+    // Hitting maximum depth; guess if playing on a budget, otherwise assume a draw
+    if (!_D)
+    {
+        return _nt->ctx->evaluate ? Negamax_evaluate(_M7) : NM_DRAW;
     }
     
     int leafScore, rootScore = _a;
     Make7 negamaxM7 = *_M7;
     
+    // Mirrored siblings score the same, so a symmetrical grid only needs its left half searched
+    bool mirror = Make7_symmetrical(_M7);
+    
     for (uint8_t tile = 4; --tile;)
     {
         for (uint8_t col = 0; col < MAKE7_SIZE; col++)
         {
-            if (Make7_drop(&negamaxM7, tile, moveOrder[col]))
+            if (mirror && (_nt->moveOrder[col] > (MAKE7_SIZE >> 1)))
+            {
+                continue;
+            }
+            
+            if (Make7_drop(&negamaxM7, tile, _nt->moveOrder[col]))
             {
                 // Drop tiles and see if our score beats the current best score
-                if ((leafScore = -Negamax_search(&negamaxM7, _tt, _D - 1, -_b, -_a)) > rootScore)
+                if ((leafScore = -Negamax_search(_nt, &negamaxM7, _D - 1, -_b, -_a)) > rootScore)
                 {
                     rootScore = leafScore;
                 }
                 
                 negamaxM7 = *_M7;
                 
-                // Update best score if it's better than the current best, and store the lower bound
+                // Update best score if it's better than the current best, and store the lower bound; a guess is never stored
                 if (_a < rootScore)
                 {
-                    TransTable_store(_tt, Make7_hashEncode(_M7), _M7->tiles23[0], _M7->tiles23[1], (_a = rootScore));
+                    _a = rootScore;
+                    
+                    if (!_nt->ctx->evaluate || (abs(_a) >= NM_WIN))
+                    {
+                        TransTable_store(_nt->table, Make7_hashEncode(_M7), _M7->tiles23[0], _M7->tiles23[1], _a, _D);
+                    }
                     
                     // Alpha cut-off
                     if (_a >= _b)
@@ -68,7 +296,10 @@ int Negamax_search(const Make7* restrict _M7, TransTable* restrict _tt, const in
     }
     
     // Save the upper bound
-    TransTable_store(_tt, Make7_hashEncode(_M7), _M7->tiles23[0], _M7->tiles23[1], _a);
+    if (!_nt->ctx->evaluate || (abs(_a) >= NM_WIN))
+    {
+        TransTable_store(_nt->table, Make7_hashEncode(_M7), _M7->tiles23[0], _M7->tiles23[1], _a, _D);
+    }
 
     return _a;
 }
@@ -76,130 +307,421 @@ int Negamax_search(const Make7* restrict _M7, TransTable* restrict _tt, const in
 int Negamax_worker(void *_args)
 {
     NegamaxArgs *nt = _args;
+    NegamaxThread worker;
+    TransTable workerTT;
+    int horizon;
     
-    mtx_lock(nt->startMtx);
+    NegamaxThread_initialize(&worker, nt->ctx, &workerTT, 0);
     
-    // Wait for the start barrier
-    while (atomic_load(nt->idle))
+    // Every root move gets a fresh table of its own for the duration of the task
+    if (!TransTable_initialize(&workerTT, nt->tableSize))
     {
-        cnd_wait(nt->startCnd, nt->startMtx);
+        fprintf(stderr, "Could not initialize the transposition table for root move #%d.\n", nt->id);
+        exit(EXIT_FAILURE);
     }
     
     // Solve this assigned position and set the result for this move
-    mtx_unlock(nt->startMtx);
-    nt->result = Negamax_solve(&nt->m7, nt->table, nt->verbose);
-    Result_increment(&nt->result);
-    nt->results[nt->move & 0xf] = nt->result;
-    mtx_lock(nt->finishMtx);
+    nt->result = Negamax_solve(&worker, &nt->m7, nt->verbose);
     
-    // Let the main thread know that this thread has finished
-    if (cnd_signal(nt->finishCnd) == thrd_success)
+    // A loss for the opponent is a win for us; nothing at this depth or deeper can be a shorter one
+    if (nt->ctx->bestOnly && (nt->result.wdl == LOSS_CHAR))
     {
-        // Decrement the number of running threads and save this thread's ID
-        atomic_fetch_sub(nt->running, 1);
-        atomic_store(nt->finishID, nt->id);
-        atomic_store(nt->solved, true);
+        for (horizon = atomic_load(&nt->ctx->horizon); (nt->result.dt7 < horizon) && !atomic_compare_exchange_weak(&nt->ctx->horizon, &horizon, nt->result.dt7););
     }
     
+    Result_increment(&nt->result);
+    nt->results[nt->move & 0xf] = nt->result;
+    TransTable_destroy(&workerTT);
+    
+    // Let the main thread know that this move has been solved
+    mtx_lock(nt->finishMtx);
+    nt->finishID[(*nt->finishCount)++] = nt->id;
+    cnd_signal(nt->finishCnd);
     mtx_unlock(nt->finishMtx);
     
     return 0;
 }
 
-Result Negamax_solve(Make7* restrict _m7, TransTable* restrict _tt, const bool _VERBOSE)
+Result Negamax_solve(NegamaxThread* restrict _nt, Make7* restrict _m7, const bool _VERBOSE)
 {
-    int solution = NM_DRAW, maxDep = MAKE7_AREA - Make7_plyNum(_m7);
+    int solution = NM_DRAW, maxDep = MAKE7_AREA - Make7_plyNum(_m7), depth = 0;
+    Result result = RESULT_UNKNOWN;
+    
+    // Only a solve over the context's own table takes checkpoints; a resumed one carries on from the iteration it was in
+    if (_nt->ctx->checkpoint && (_nt->table == &_nt->ctx->table))
+    {
+        depth = Checkpoint_begin(_nt->ctx->checkpoint, _nt, _m7, CK_SOLVE, nullptr, nullptr, nullptr);
+    }
     
     // Iterative deepening to solve shallow wins and losses
-    for (int depth = 0; depth < maxDep; depth++)
+    for (; (depth < maxDep) && !atomic_load(&_nt->ctx->stop); depth++)
     {
+        // A shorter win was already proven elsewhere
+        if (depth >= atomic_load(&_nt->ctx->horizon))
+        {
+            break;
+        }
+        
+        _nt->rootDepth = depth;
+        
         if (_VERBOSE)
         {
-            printf("\rSolving...%d\r", depth);
+            printf("\rSolving...%d %llu\r", depth, Negamax_nodes(_nt->ctx));
 #ifdef __unix__
             fflush(stdout);
 #endif
         }
         
-        if (abs((solution = Negamax_search(_m7, _tt, depth, -NM_WIN, NM_WIN))) >= NM_WIN)
+        if (abs((solution = Negamax_search(_nt, _m7, depth, -NM_WIN, NM_WIN))) >= NM_WIN)
         {
-            return (Result) { solution > 0 ? WIN_CHAR : LOSS_CHAR, depth };
+            result = (Result) { solution > 0 ? WIN_CHAR : LOSS_CHAR, depth };
+            break;
         }
     }
     
-    return RESULT_DRAW;
+    // An interrupted search proves nothing
+    if ((depth == maxDep) && !atomic_load(&_nt->ctx->stop) && (_nt->rootDepth < atomic_load(&_nt->ctx->horizon)))
+    {
+        result = RESULT_DRAW;
+    }
+    
+    if (_nt->ctx->checkpoint && (_nt->ctx->checkpoint->owner == _nt))
+    {
+        Checkpoint_end(_nt->ctx->checkpoint);
+    }
+    
+    return result;
 }
 
-Result Negamax_solve_parallel(Make7* restrict _m7, const bool _VERBOSE, Result *_r1, Result *_r2, Result *_r3, Result *_bestResl, uint8_t *_bestMove)
+void Negamax_rank(Make7* restrict _childM7, uint8_t* restrict _move, int* restrict _value, const uint8_t _COUNT)
 {
-    int thr, tileN, colN, finished, terminals;
-    atomic_int thrRunners, finishTID;
-    unsigned thrTableSize;
-    Result bestResl;
-    uint8_t dropList[MAKE7_SIZE_X3], dropCount, nextUnsolved;
-    atomic_bool idle, thrSolved;
-    mtx_t thrFinishMutex, thrStartMutex;
-    cnd_t thrFinishCondV, thrStartCondV;
+    Make7 childM7;
+    uint8_t move;
+    int value, i, j;
     
-    // Generate all possible moves in the given position
-    Make7_generate(_m7, dropList, &dropCount);
+    // Insertion sort from best to worst; moves that score the same keep their search order
+    for (i = 1; i < _COUNT; i++)
+    {
+        childM7 = _childM7[i];
+        move = _move[i];
+        value = _value[i];
+        
+        for (j = i; (j > 0) && (_value[j - 1] < value); j--)
+        {
+            _childM7[j] = _childM7[j - 1];
+            _move[j] = _move[j - 1];
+            _value[j] = _value[j - 1];
+        }
+        
+        _childM7[j] = childM7;
+        _move[j] = move;
+        _value[j] = value;
+    }
+}
+
+Result Negamax_solve_limited(NegamaxThread* restrict _nt, Make7* restrict _m7, const NegamaxLimits _LIMITS, uint8_t* restrict _bestMove, const bool _VERBOSE)
+{
+    NegamaxContext *ctx = _nt->ctx;
+    int depth, score, alpha, searched = 0, maxDep = MAKE7_AREA - Make7_plyNum(_m7) - 1, value[MAKE7_SIZE_X3];
+    uint8_t move[MAKE7_SIZE_X3], open, mv, lostMove;
+    Make7 childM7[MAKE7_SIZE_X3];
+    Result result = RESULT_UNKNOWN;
+    void (*interrupted)(int) = SIG_DFL;
     
-    // Thread handles and arguments
-    thrd_t thread[dropCount];
-    NegamaxArgs thrArgs[dropCount];
-    bool winOnFirst[dropCount];
-    TransTable thrTT[dropCount];
+    // Order the root moves like the search does so that the best move so far favors the center
+    Negamax_generate(_nt, _m7, move, &open);
+    
+    for (mv = 0; mv < open; mv++)
+    {
+        childM7[mv] = *_m7;
+        Make7_drop(&childM7[mv], move[mv] >> 4, move[mv] & 0xf);
+        
+        // Nothing beats making 7 right away
+        if (Make7_tilesSumTo7(&childM7[mv]))
+        {
+            *_bestMove = move[mv];
+            return (Result) { WIN_CHAR, 0 };
+        }
+    }
     
-    // Perform lazy thread creation; one drop move per thread
-#if defined (_WIN64) || defined (_WIN32)
-    if ((thrCount = GetMaximumProcessorCount(ALL_PROCESSOR_GROUPS)) > dropCount)
+    if (!open)
     {
-        thrCount = dropCount;
+        return RESULT_DRAW;
     }
-#elifdef __unix__
-    if ((thrCount = sysconf(_SC_NPROCESSORS_ONLN)) > dropCount)
+    
+    *_bestMove = lostMove = move[0];
+    
+    // Arm the budget; Ctrl-C cuts it short too
+    ctx->nodeCap = _LIMITS.nodes ? Negamax_nodes(ctx) + _LIMITS.nodes : 0;
+    ctx->deadline = (_LIMITS.seconds > 0.0) ? Negamax_clock() + (unsigned long long)(_LIMITS.seconds * 1e9) : 0;
+    ctx->limited = true;
+    
+    if (ctx->console)
     {
-        thrCount = dropCount;
+        atomic_store(&negamaxInterrupt, &ctx->stop);
+        interrupted = signal(SIGINT, Negamax_interrupt);
     }
+    
+    // Deepen every move that is not yet lost; a proof found on the way out is still a proof
+    for (depth = 0; open && (depth < maxDep) && !atomic_load(&ctx->stop); depth++)
+    {
+        _nt->rootDepth = depth;
+        
+        if (_VERBOSE)
+        {
+            printf("\rSolving...%d %llu\r", depth, Negamax_nodes(ctx));
+#ifdef __unix__
+            fflush(stdout);
 #endif
+        }
+        
+        for (mv = 0; mv < open;)
+        {
+            score = Negamax_search(_nt, &childM7[mv], depth, -NM_WIN, NM_WIN);
+            
+            // The opponent loses after this move
+            if (score == -NM_WIN)
+            {
+                *_bestMove = move[mv];
+                result = (Result) { WIN_CHAR, depth + 1 };
+                open = 0;
+                break;
+            }
+            
+            // The opponent wins after this move; the first one to fall at the deepest depth holds out the longest
+            if (score == NM_WIN)
+            {
+                if (result.dt7 <= depth)
+                {
+                    lostMove = move[mv];
+                    result = (Result) { LOSS_CHAR, depth + 1 };
+                }
+                
+                // Close it, keeping the rest in search order
+                memmove(&childM7[mv], &childM7[mv + 1], sizeof(*childM7) * (open - mv - 1));
+                memmove(&move[mv], &move[mv + 1], sizeof(*move) * (open - mv - 1));
+                open--;
+                continue;
+            }
+            
+            if (atomic_load(&ctx->stop))
+            {
+                break;
+            }
+            
+            mv++;
+        }
+        
+        // Only a finished iteration rules anything out
+        if (atomic_load(&ctx->stop))
+        {
+            break;
+        }
+        
+        searched = depth + 1;
+        
+        // Guess at the leaves one ply short to rank the moves that are still open; the proofs above are kept apart as guesses would blunt their cut-offs
+        ctx->evaluate = true;
+        
+        for (mv = 0, alpha = -NM_WIN; (mv < open) && !atomic_load(&ctx->stop); mv++)
+        {
+            if ((value[mv] = -Negamax_search(_nt, &childM7[mv], depth ? depth - 1 : 0, -NM_WIN, -alpha)) > alpha)
+            {
+                alpha = value[mv];
+            }
+        }
+        
+        ctx->evaluate = false;
+        
+        if (!atomic_load(&ctx->stop))
+        {
+            Negamax_rank(childM7, move, value, open);
+        }
+    }
     
-    // Make it work with systems with low memory requirements
-    if ((thrTableSize = TransTable_prevprime((table.size + 2) / thrCount)) <= 3)
+    // Hand Ctrl-C back to whoever had it before, such as the server removing its socket
+    if (ctx->console)
     {
-        thrTableSize = TT_HASHSIZE;
+        signal(SIGINT, (interrupted == SIG_ERR) ? SIG_DFL : interrupted);
+        atomic_store(&negamaxInterrupt, nullptr);
+    }
+    
+    atomic_store(&ctx->stop, false);
+    ctx->limited = false;
+    
+    // Some moves are still open; play the one the evaluation liked best, as nothing has been proven about it
+    if (open)
+    {
+        *_bestMove = move[0];
+        
+        // Every open move was searched to the end without a proof
+        if (searched >= maxDep)
+        {
+            return RESULT_DRAW;
+        }
+        
+        // No forced result within the plies fully searched
+        return (Result) { UNKNOWN_CHAR, searched };
+    }
+    
+    if (result.wdl == LOSS_CHAR)
+    {
+        *_bestMove = lostMove;
+    }
+    
+    return result;
+}
+
+void Negamax_generate(const NegamaxThread* restrict _NT, const Make7* restrict _M7, uint8_t* restrict _list, uint8_t* restrict _count)
+{
+    Make7 dropM7 = *_M7;
+    
+    *_count = 0;
+    
+    // Same order as the search: highest tile first, then center to outermost
+    for (uint8_t tile = 4; --tile;)
+    {
+        for (uint8_t col = 0; col < MAKE7_SIZE; col++)
+        {
+            if (Make7_drop(&dropM7, tile, _NT->moveOrder[col]))
+            {
+                _list[(*_count)++] = (tile << 4) | _NT->moveOrder[col];
+                dropM7 = *_M7;
+            }
+        }
+    }
+}
+
+int Negamax_principalVariation(NegamaxThread* restrict _nt, const Make7* restrict _M7, const Result _RESULT, uint8_t* restrict _line)
+{
+    Make7 pvM7 = *_M7, childM7;
+    uint8_t dropList[MAKE7_SIZE_X3], dropCount, mv;
+    int length = 0, depth = _RESULT.dt7;
+    bool winning = _RESULT.wdl == WIN_CHAR;
+    
+    // Draws have no forced line to follow
+    if ((_RESULT.wdl != WIN_CHAR) && (_RESULT.wdl != LOSS_CHAR))
+    {
+        return 0;
+    }
+    
+    // Walk down the tree one ply at a time; every probe is a shallow search the solve has already stored in the table
+    for (;; depth--, winning = !winning)
+    {
+        Negamax_generate(_nt, &pvM7, dropList, &dropCount);
+        
+        for (mv = 0; mv < dropCount; mv++)
+        {
+            childM7 = pvM7;
+            Make7_drop(&childM7, dropList[mv] >> 4, dropList[mv] & 0xf);
+            
+            // Only the final move of a win makes 7
+            if (Make7_tilesSumTo7(&childM7))
+            {
+                if (winning && !depth)
+                {
+                    break;
+                }
+                
+                continue;
+            }
+            
+            // The winner keeps to the shortest win; the loser holds out for the longest loss
+            if (winning ? (depth && (Negamax_search(_nt, &childM7, depth - 1, -NM_WIN, NM_WIN) == -NM_WIN)) : ((depth < 2) || (Negamax_search(_nt, &childM7, depth - 2, -NM_WIN, NM_WIN) != NM_WIN)))
+            {
+                break;
+            }
+        }
+        
+        // Nothing matched; the result given was not this position's
+        if (mv == dropCount)
+        {
+            break;
+        }
+        
+        _line[length++] = dropList[mv];
+        
+        if (Make7_tilesSumTo7(&childM7))
+        {
+            break;
+        }
+        
+        pvM7 = childM7;
+    }
+    
+    return length;
+}
+
+// A drawn position has no line to follow; any move the opponent cannot force a win against keeps the draw, and the solve left those probes in the table
+uint8_t Negamax_drawingMove(NegamaxThread* restrict _nt, const Make7* restrict _M7)
+{
+    uint8_t dropList[MAKE7_SIZE_X3], dropCount, mv;
+    int depth = MAKE7_AREA - Make7_plyNum(_M7) - 2;
+    Make7 childM7;
+    
+    Negamax_generate(_nt, _M7, dropList, &dropCount);
+    
+    for (mv = 0; mv < dropCount; mv++)
+    {
+        childM7 = *_M7;
+        Make7_drop(&childM7, dropList[mv] >> 4, dropList[mv] & 0xf);
+        
+        if ((depth < 0) || (Negamax_search(_nt, &childM7, depth, -NM_WIN, NM_WIN) != NM_WIN))
+        {
+            return dropList[mv];
+        }
     }
+    
+    return dropCount ? dropList[0] : 0;
+}
 
+Result Negamax_solve_parallel(NegamaxContext* restrict _ctx, Make7* restrict _m7, const bool _VERBOSE, Result *_r1, Result *_r2, Result *_r3, Result *_bestResl, uint8_t *_bestMove)
+{
+    int thr, tileN, colN, finished, finishCount, printed, tasks, workers;
+    bool settled, mirror;
+    size_t thrTableSize;
+    Result bestResl;
+    uint8_t dropList[MAKE7_SIZE_X3], dropCount;
+    mtx_t thrFinishMutex;
+    cnd_t thrFinishCondV;
+    
+    // Generate all possible moves in the given position
+    Make7_generate(_m7, dropList, &dropCount);
+    
+    // Task arguments; one drop move per task
+    NegamaxArgs thrArgs[dropCount];
+    bool winOnFirst[dropCount], mirrored[dropCount];
+    int finishID[dropCount];
+    
+    // Moves on the right half of a symmetrical grid score the same as their mirror images on the left
+    mirror = Make7_symmetrical(_m7);
+    
     // Initialize the results with unknown values
     for (thr = 0; thr < MAKE7_SIZE; thr++)
     {
         _r1[thr].wdl = _r2[thr].wdl = _r3[thr].wdl = UNKNOWN_CHAR;
     }
     
-    // Initialize game states, mutexes, condition variables, and results
-    for (terminals = thr = 0; thr < dropCount; thr++)
+    // Initialize game states and results
+    for (settled = false, tasks = thr = 0; thr < dropCount; thr++)
     {
         thrArgs[thr] = (NegamaxArgs)
         {
             .m7 = *_m7,
-            .running = &thrRunners,
-            .finishID = &finishTID,
-            .idle = &idle,
-            .solved = &thrSolved,
-            .startMtx = &thrStartMutex,
+            .ctx = _ctx,
             .finishMtx = &thrFinishMutex,
-            .startCnd = &thrStartCondV,
             .finishCnd = &thrFinishCondV,
-            .table = &thrTT[thr],
+            .finishID = finishID,
+            .finishCount = &finishCount,
             .id = thr,
             .move = dropList[thr],
             .verbose = _VERBOSE
         };
         
-        winOnFirst[thr] = false;
         tileN = dropList[thr] >> 4;
         Make7_drop(&thrArgs[thr].m7, tileN, dropList[thr] & 0xf);
         
-        // Assign the results array to the correct thread
+        // Assign the results array to the correct task
         switch (tileN)
         {
         case 1:
@@ -212,30 +734,38 @@ Result Negamax_solve_parallel(Make7* restrict _m7, const bool _VERBOSE, Result *
             thrArgs[thr].results = _r3;
         }
         
-        // Search for a win on the first move and do not create a thread for it
-        if (Make7_tilesSumTo7(&thrArgs[thr].m7))
+        // Search for a win on the first move and do not queue a task for it, nor for a mirror image
+        mirrored[thr] = mirror && ((dropList[thr] & 0xf) > (MAKE7_SIZE >> 1));
+        
+        if ((winOnFirst[thr] = Make7_tilesSumTo7(&thrArgs[thr].m7)))
         {
-            winOnFirst[thr] = true;
-            terminals++;
+            settled = true;
+        }
+        else if (!mirrored[thr])
+        {
+            tasks++;
         }
     }
     
-    // Initialize the mutex and condition variable
-    if (mtx_init(&thrStartMutex, mtx_plain) != thrd_success)
+    // Nothing beats winning right away, so there is no need to search the rest
+    if (settled && _ctx->bestOnly)
     {
-        fprintf(stderr, "Could not initialize the mutex to start the negamax worker threads.\n");
-        exit(EXIT_FAILURE);
+        tasks = 0;
     }
     
-    if (mtx_init(&thrFinishMutex, mtx_plain) != thrd_success)
+    // No more tasks than workers run at once, so the table is split between whichever is fewer
+    workers = tasks < _ctx->pool->count ? tasks : _ctx->pool->count;
+    
+    // Make it work with systems with low memory requirements
+    if ((thrTableSize = TransTable_prevprime((_ctx->table.size + 2) / (workers ? workers : 1))) <= 3)
     {
-        fprintf(stderr, "Could not initialize the mutex for the negamax worker threads.\n");
-        exit(EXIT_FAILURE);
+        thrTableSize = TT_HASHSIZE;
     }
     
-    if (cnd_init(&thrStartCondV) != thrd_success)
+    // Initialize the mutex and condition variable
+    if (mtx_init(&thrFinishMutex, mtx_plain) != thrd_success)
     {
-        fprintf(stderr, "Could not initialize the condition variable to start the negamax worker threads.\n");
+        fprintf(stderr, "Could not initialize the mutex for the negamax worker threads.\n");
         exit(EXIT_FAILURE);
     }
     
@@ -245,113 +775,55 @@ Result Negamax_solve_parallel(Make7* restrict _m7, const bool _VERBOSE, Result *
         exit(EXIT_FAILURE);
     }
     
-    nextUnsolved = thrCount - terminals;
-    atomic_init(&thrRunners, 0);
-    atomic_init(&thrSolved, false);
-    atomic_init(&idle, true);
+    finishCount = 0;
+    atomic_store(&_ctx->horizon, INT_MAX);
     
-    // Solve the position in parallel; each thread holds a copy of the game state to ensure no data races when making moves
+    // Solve the position in parallel; each task holds a copy of the game state to ensure no data races when making moves
     // It is difficult to parallelize minimax with alpha-beta pruning effectively, as it is an inherently sequential algorithm
-    for (thr = 0; thr < thrCount; thr++)
+    // Idle workers steal queued root moves from busy ones, so a long move does not hold up the rest
+    for (thr = 0; thr < dropCount; thr++)
     {
-        // Start the threads
-        if (!winOnFirst[thr])
+        if (!winOnFirst[thr] && !mirrored[thr] && tasks)
         {
-            if (!TransTable_initialize(&thrTT[thr], thrTableSize + 2))
-            {
-                fprintf(stderr, "Could not initialize the transposition table for thread #%d.\n", thr);
-                exit(EXIT_FAILURE);
-            }
-            
-            switch (thrd_create(&thread[thr], Negamax_worker, &thrArgs[thr]))
-            {
-            case thrd_error:
-                fprintf(stderr, "Could not create thread #%d.\n", thr);
-                exit(EXIT_FAILURE);
-            case thrd_nomem:
-                fprintf(stderr, "Could not allocate thread #%d.\n", thr);
-                exit(EXIT_FAILURE);
-            default:
-                atomic_fetch_add(&thrRunners, 1);
-                break;
-            }
+            thrArgs[thr].tableSize = thrTableSize + 2;
+            ThreadPool_submit(_ctx->pool, Negamax_worker, &thrArgs[thr]);
         }
     }
     
-    // 
-    atomic_store(&idle, false);
-    
-    // Signal the worker threads to continue after the barrier
-    //mtx_lock(&thrStartMutex);
-    cnd_broadcast(&thrStartCondV);
-    //mtx_unlock(&thrStartMutex);
+    // Print the results as the tasks finish
+    mtx_lock(&thrFinishMutex);
     
-    // Wait for the threads to finish
-    while (atomic_load(&thrRunners))
+    for (printed = 0; printed < tasks; printed++)
     {
-        mtx_lock(&thrFinishMutex);
-        
-        // Check if a thread notified us it has finished solving
-        if (atomic_load(&thrSolved))
+        while (printed == finishCount)
         {
-            // Print the finished thread's results
-            finished = atomic_load(&finishTID);
-            printf("%d%c ", dropList[finished] >> 4, 'A' + (dropList[finished] & 0xf));
-            Result_print(&thrArgs[finished].result, _bestResl ? _bestResl : &thrArgs[finished].result);
-            puts("");
-            
-            // Reassign that thread to another unsolved move whenever possible
-            if (nextUnsolved < dropCount)
-            {
-                thrArgs[finished].m7 = *_m7;
-                Make7_drop(&thrArgs[finished].m7, dropList[nextUnsolved] >> 4, dropList[nextUnsolved] & 0xf);
-                TransTable_destroy(&thrTT[finished]);
-                
-                if (!TransTable_initialize(&thrTT[nextUnsolved], thrTableSize + 2))
-                {
-                    fprintf(stderr, "Could not reinitialize the transposition table for thread #%d.\n", finished);
-                    exit(EXIT_FAILURE);
-                }
-                
-                switch (thrd_create(&thread[finished], Negamax_worker, &thrArgs[nextUnsolved]))
-                {
-                case thrd_error:
-                    fprintf(stderr, "Could not reassign thread #%d to another unsolved move.\n", thr);
-                    exit(EXIT_FAILURE);
-                case thrd_nomem:
-                    fprintf(stderr, "Could not allocate thread #%d for reassignment to another unsolved move.\n", thr);
-                    exit(EXIT_FAILURE);
-                default:
-                    atomic_fetch_add(&thrRunners, 1);
-                    nextUnsolved++;
-                }
-            }
-            
-            atomic_store(&thrSolved, false);
+            cnd_wait(&thrFinishCondV, &thrFinishMutex);
         }
-        else
+        
+        finished = finishID[printed];
+        
+        if (!_VERBOSE)
         {
-            // Wait for a signal from the threads
-            cnd_wait(&thrFinishCondV, &thrFinishMutex);
+            continue;
         }
         
-        mtx_unlock(&thrFinishMutex);
-    }
-    
-    // Join the threads to the main thread
-    for (thr = 0; thr < thrCount; thr++)
-    {
-        if (!winOnFirst[thr])
+        printf("%d%c ", dropList[finished] >> 4, 'A' + (dropList[finished] & 0xf));
+        Result_print(&thrArgs[finished].result, _bestResl ? _bestResl : &thrArgs[finished].result);
+        puts("");
+        
+        // The mirror image has the same result
+        if (mirror && ((dropList[finished] & 0xf) < (MAKE7_SIZE >> 1)))
         {
-            if (thrd_join(thread[thr], NULL) == thrd_error)
-            {
-                fprintf(stderr, "Could not join negamax worker thread #%d to the main thread.\n", thr);
-            }
-            
-            TransTable_destroy(&thrTT[thr]);
+            printf("%d%c ", dropList[finished] >> 4, 'A' + MAKE7_SIZE_M1 - (dropList[finished] & 0xf));
+            Result_print(&thrArgs[finished].result, _bestResl ? _bestResl : &thrArgs[finished].result);
+            puts("");
         }
     }
     
+    mtx_unlock(&thrFinishMutex);
+    ThreadPool_wait(_ctx->pool);
+    atomic_store(&_ctx->horizon, INT_MAX);
+    
     // Look for immediate wins
     for (thr = 0; thr < dropCount; thr++)
     {
@@ -376,6 +848,14 @@ Result Negamax_solve_parallel(Make7* restrict _m7, const bool _VERBOSE, Result *
         }
     }
     
+    // Copy the left half's results to the right half
+    for (colN = 0; mirror && (colN < (MAKE7_SIZE >> 1)); colN++)
+    {
+        _r1[MAKE7_SIZE_M1 - colN] = _r1[colN];
+        _r2[MAKE7_SIZE_M1 - colN] = _r2[colN];
+        _r3[MAKE7_SIZE_M1 - colN] = _r3[colN];
+    }
+    
     if (!_bestResl) // Find the best result from the threads
     {
         bestResl = Result_getBestResult(_r1, _r2, _r3);
@@ -386,147 +866,257 @@ Result Negamax_solve_parallel(Make7* restrict _m7, const bool _VERBOSE, Result *
         *_bestMove = Result_getBestMove(_r1, _r2, _r3);
     }
     
-    // Clean up mutexes and condition variables
+    // Clean up the mutex and condition variable
     mtx_destroy(&thrFinishMutex);
-    mtx_destroy(&thrStartMutex);
     cnd_destroy(&thrFinishCondV);
-    cnd_destroy(&thrStartCondV);
     
     return _bestResl ? *_bestResl : bestResl;
 }
 
-void Negamax_results(Make7* restrict _m7, Result *_r1, Result *_r2, Result *_r3, Result *_best)
-{    
-    // Check to see if the mirror image of the game state is the same
-    // If so, only search the left side of the grid
-    bool mirror = Make7_symmetrical(_m7);
-    uint8_t cEnd = mirror ? 4 : MAKE7_SIZE, tile, col;
-    Make7 resultM7 = *_m7;
+int Negamax_lazyWorker(void *_args)
+{
+    NegamaxLazyArgs *nl = _args;
+    NegamaxThread helper;
+    struct timespec nap = {.tv_nsec = 1000000};
+    int depth, searched, score, proof;
     
-    // Flush results with unknown values
-    for (tile = 0; tile < cEnd; tile++)
+    NegamaxThread_initialize(&helper, nl->ctx, &nl->ctx->table, nl->id);
+    
+    for (searched = -1; !atomic_load(&nl->ctx->stop);)
+    {
+        // Odd helpers run one ply ahead of the main thread; never go any further than that, or the proof may not be the shortest one
+        if ((depth = atomic_load(nl->mainDepth) + (nl->id & 1)) <= searched)
+        {
+            depth = searched + 1;
+        }
+        
+        if ((depth > atomic_load(nl->mainDepth) + 1) || (depth >= nl->maxDepth))
+        {
+            thrd_sleep(&nap, nullptr);
+            continue;
+        }
+        
+        score = Negamax_search(&helper, &nl->m7, depth, -NM_WIN, NM_WIN);
+        
+        if (atomic_load(&nl->ctx->stop))
+        {
+            break;
+        }
+        
+        searched = depth;
+        
+        if (abs(score) >= NM_WIN)
+        {
+            // Keep the shallowest proof; its sign never changes with depth
+            atomic_store(nl->proofScore, score);
+            
+            for (proof = atomic_load(nl->proofDepth); (depth < proof) && !atomic_compare_exchange_weak(nl->proofDepth, &proof, depth););
+            
+            // The main thread has already ruled out anything shallower, so this is the answer
+            if (depth == atomic_load(nl->mainDepth))
+            {
+                atomic_store(&nl->ctx->stop, true);
+            }
+            
+            break;
+        }
+    }
+    
+    return 0;
+}
+
+Result Negamax_solve_lazy(NegamaxContext* restrict _ctx, Make7* restrict _m7, const bool _VERBOSE)
+{
+    int thr, depth, solution, maxDep = MAKE7_AREA - Make7_plyNum(_m7);
+    atomic_int mainDepth, proofDepth, proofScore;
+    NegamaxThread mainThread;
+    Result result = RESULT_DRAW;
+    bool stopped = false;
+    
+    // The calling thread is the main thread and takes up one core; pool workers on the others help through the table
+    int helpers = _ctx->pool->count > 1 ? _ctx->pool->count - 1 : 1;
+    NegamaxLazyArgs lazyArgs[helpers];
+    
+    NegamaxThread_initialize(&mainThread, _ctx, &_ctx->table, 0);
+    atomic_init(&mainDepth, 0);
+    atomic_init(&proofDepth, INT_MAX);
+    atomic_init(&proofScore, NM_DRAW);
+    
+    for (thr = 0; thr < helpers; thr++)
     {
-        _r1[tile].wdl = _r2[tile].wdl = _r3[tile].wdl = UNKNOWN_CHAR;
+        lazyArgs[thr] = (NegamaxLazyArgs)
+        {
+            .m7 = *_m7,
+            .ctx = _ctx,
+            .mainDepth = &mainDepth,
+            .proofDepth = &proofDepth,
+            .proofScore = &proofScore,
+            .id = thr + 1,
+            .maxDepth = maxDep
+        };
+        
+        ThreadPool_submit(_ctx->pool, Negamax_lazyWorker, &lazyArgs[thr]);
     }
     
-    // Loop through all possible drop moves and assign results
-    for (tile = 1; tile <= 3; tile++)
+    // The main thread deepens one ply at a time like the serial solver
+    for (depth = 0; depth < maxDep; depth++)
     {
-        printf("%d ", tile);
+        atomic_store(&mainDepth, depth);
         
-        for (col = 0; col < cEnd; col++)
+        if (_VERBOSE)
         {
+            printf("\rSolving...%d %llu\r", depth, Negamax_nodes(_ctx));
 #ifdef __unix__
             fflush(stdout);
 #endif
-            if (Make7_drop(&resultM7, tile, col))
+        }
+        
+        solution = Negamax_search(&mainThread, _m7, depth, -NM_WIN, NM_WIN);
+        
+        // A helper proved the root at this depth and stopped us; any other stop came from outside, and an interrupted search proves nothing
+        if (atomic_load(&_ctx->stop))
+        {
+            if (atomic_load(&proofDepth) == depth)
             {
-                
-                // Look for immediate wins
-                if (Make7_tilesSumTo7(&resultM7))
-                {
-                    switch (tile)
-                    {
-                    case 1:
-                        _r1[col].wdl = WIN_CHAR;
-                        _r1[col].dt7 = 0;
-                        
-                        if (mirror)
-                        {
-                            _r1[MAKE7_SIZE_M1 - col].wdl = WIN_CHAR;
-                            _r1[MAKE7_SIZE_M1 - col].dt7 = 0;
-                        }
-                        break;
-                    case 2:
-                        _r2[col].wdl = WIN_CHAR;
-                        _r2[col].dt7 = 0;
-                        
-                        if (mirror)
-                        {
-                            _r2[MAKE7_SIZE_M1 - col].wdl = WIN_CHAR;
-                            _r2[MAKE7_SIZE_M1 - col].dt7 = 0;
-                        }
-                        break;
-                    case 3:
-                        _r3[col].wdl = WIN_CHAR;
-                        _r3[col].dt7 = 0;
-                        
-                        if (mirror)
-                        {
-                            _r3[MAKE7_SIZE_M1 - col].wdl = WIN_CHAR;
-                            _r3[MAKE7_SIZE_M1 - col].dt7 = 0;
-                        }
-                    }
-                }
-                else
-                {
-                    TransTable_destroy(&table);
-                    TransTable_initialize(&table, table.size += 2);
-                    
-                    // Solve for each move, as there is no win
-                    switch (tile)
-                    {
-                    case 1:
-                        _r1[col] = Negamax_solve(&resultM7, &table, false);
-                        Result_increment(&_r1[col]);
-                        
-                        if (mirror)
-                        {
-                            _r1[MAKE7_SIZE_M1 - col] = _r1[col];
-                        }
-                        break;
-                    case 2:
-                        _r2[col] = Negamax_solve(&resultM7, &table, false);
-                        Result_increment(&_r2[col]);
-                        
-                        if (mirror)
-                        {
-                            _r2[MAKE7_SIZE_M1 - col] = _r2[col];
-                        }
-                        break;
-                    case 3:
-                        _r3[col] = Negamax_solve(&resultM7, &table, false);
-                        Result_increment(&_r3[col]);
-                        
-                        if (mirror)
-                        {
-                            _r3[MAKE7_SIZE_M1 - col] = _r3[col];
-                        }
-                    }
-                }
-                
-                resultM7 = *_m7;
+                result = (Result) { atomic_load(&proofScore) > 0 ? WIN_CHAR : LOSS_CHAR, depth };
             }
-            
-            // Print the results
-            switch (tile)
+            else
             {
-            case 1:
-                Result_print(&_r1[col], _best);
-                break;
-            case 2:
-                Result_print(&_r2[col], _best);
-                break;
-            case 3:
-                Result_print(&_r3[col], _best);
+                result = RESULT_UNKNOWN;
+                stopped = true;
             }
+            
+            break;
+        }
+        
+        if (abs(solution) >= NM_WIN)
+        {
+            result = (Result) { solution > 0 ? WIN_CHAR : LOSS_CHAR, depth };
+            break;
+        }
+        
+        // A helper one ply ahead already has the answer for the next depth
+        if (atomic_load(&proofDepth) == depth + 1)
+        {
+            result = (Result) { atomic_load(&proofScore) > 0 ? WIN_CHAR : LOSS_CHAR, depth + 1 };
+            break;
+        }
+    }
+    
+    // Bring the helpers home; a stop from outside stays set for the caller to see, as it does after the serial solver
+    atomic_store(&_ctx->stop, true);
+    ThreadPool_wait(_ctx->pool);
+    atomic_store(&_ctx->stop, stopped);
+    
+    return result;
+}
+
+void Negamax_analyze(NegamaxContext* restrict _ctx, Make7* restrict _m7, Result *_r1, Result *_r2, Result *_r3)
+{
+    // Check to see if the mirror image of the game state is the same
+    // If so, only search the left side of the grid
+    bool mirror = Make7_symmetrical(_m7);
+    int depth, score, maxDep = MAKE7_AREA - Make7_plyNum(_m7) - 1;
+    uint8_t dropList[MAKE7_SIZE_X3], dropCount, open, mv, col;
+    Make7 childM7[MAKE7_SIZE_X3];
+    Result *childResl[MAKE7_SIZE_X3], *tileResl;
+    NegamaxThread analysis;
+    
+    NegamaxThread_initialize(&analysis, _ctx, &_ctx->table, 0);
+    Make7_generate(_m7, dropList, &dropCount);
+    
+    // Flush results with unknown values
+    for (col = 0; col < MAKE7_SIZE; col++)
+    {
+        _r1[col] = _r2[col] = _r3[col] = RESULT_UNKNOWN;
+    }
+    
+    // A resumed analysis gets back the moves it had settled and the depth it was at
+    depth = _ctx->checkpoint ? Checkpoint_begin(_ctx->checkpoint, &analysis, _m7, CK_ANALYZE, _r1, _r2, _r3) : 0;
+    
+    // Settle immediate wins right away and keep the rest open
+    for (open = mv = 0; mv < dropCount; mv++)
+    {
+        col = dropList[mv] & 0xf;
+        tileResl = ((dropList[mv] >> 4) == 1) ? _r1 : ((dropList[mv] >> 4) == 2) ? _r2 : _r3;
+        
+        if ((mirror && (col > (MAKE7_SIZE >> 1))) || (tileResl[col].wdl != UNKNOWN_CHAR))
+        {
+            continue;
+        }
+        
+        childM7[open] = *_m7;
+        Make7_drop(&childM7[open], dropList[mv] >> 4, col);
+        
+        if (Make7_tilesSumTo7(&childM7[open]))
+        {
+            tileResl[col] = (Result) { WIN_CHAR, 0 };
         }
+        else
+        {
+            childResl[open++] = &tileResl[col];
+        }
+    }
+    
+    // Deepen every open move together; the table is never cleared, so each move reuses whatever the main solve and its siblings proved
+    for (; open && (depth < maxDep) && !atomic_load(&_ctx->stop); depth++)
+    {
+        analysis.rootDepth = depth;
         
-        // Print it for the right half if the grid is symmetrical
-        for (; mirror && (col < MAKE7_SIZE); col++)
+        for (mv = 0; mv < open;)
         {
-            switch (tile)
+            if (abs((score = Negamax_search(&analysis, &childM7[mv], depth, -NM_WIN, NM_WIN))) >= NM_WIN)
             {
-            case 1:
-                Result_print(&_r1[col], _best);
-                break;
-            case 2:
-                Result_print(&_r2[col], _best);
-                break;
-            case 3:
-                Result_print(&_r3[col], _best);
+                *childResl[mv] = (Result) { score > 0 ? WIN_CHAR : LOSS_CHAR, depth };
+                Result_increment(childResl[mv]);
+                
+                // Close this move by moving the last open one into its place
+                childM7[mv] = childM7[--open];
+                childResl[mv] = childResl[open];
+            }
+            else
+            {
+                mv++;
             }
         }
+    }
+    
+    if (_ctx->checkpoint)
+    {
+        Checkpoint_end(_ctx->checkpoint);
+    }
+    
+    // Nobody can force a win from the moves still open, unless the analysis was stopped before it was done
+    while (open)
+    {
+        *childResl[--open] = atomic_load(&_ctx->stop) ? RESULT_UNKNOWN : RESULT_DRAW;
+    }
+    
+    // Copy the left half's results to the right half
+    for (col = 0; mirror && (col < (MAKE7_SIZE >> 1)); col++)
+    {
+        _r1[MAKE7_SIZE_M1 - col] = _r1[col];
+        _r2[MAKE7_SIZE_M1 - col] = _r2[col];
+        _r3[MAKE7_SIZE_M1 - col] = _r3[col];
+    }
+}
+
+void Negamax_results(NegamaxContext* restrict _ctx, Make7* restrict _m7, Result *_r1, Result *_r2, Result *_r3, Result *_best)
+{
+    uint8_t tile, col;
+    
+    Negamax_analyze(_ctx, _m7, _r1, _r2, _r3);
+    
+    // Print the results by tile and column
+    for (tile = 1; tile <= 3; tile++)
+    {
+        printf("%d ", tile);
+        
+        for (col = 0; col < MAKE7_SIZE; col++)
+        {
+            Result_print(tile == 1 ? &_r1[col] : tile == 2 ? &_r2[col] : &_r3[col], _best);
+        }
+        
         puts("");
     }
 }
@@ -11,6 +11,7 @@
     An optimization called alpha-beta pruning cut branches of the tree if the current score is worse than the best score found so far.
     This saves time and nodes by not having to search the entire tree, as long there is good move ordering.
     A static move ordering technique, from center to edge, is used to improve the efficiency of alpha-beta.
+    Moves on either side of a symmetrical grid mirror each other and score the same, so only the left half of such a position is searched.
     
     Even with alpha-beta pruning, there can be transpositions, move sequences that result in the same game state.
     By storing the scores of these game states to the transposition table, minimax avoids having to recompute them every time.
@@ -18,6 +19,17 @@
     
     To futher increase the performance of the algorithm, iterative deepening is used, where the depth is increased by one per iteration.
     It allows minimax to solve game states that have shallow wins or losses, but those deeper in the tree will take longer to solve.
+    
+    Lazy SMP is offered as an alternative to splitting the root moves between threads.
+    Every thread searches the same root with its own column order, and odd helpers run one ply ahead of the main thread.
+    They only communicate through the shared transposition table, so whatever one thread proves is a table hit for all the others.
+    
+    A budgeted solve cannot reach the end of the game, so it guesses at the leaves with a heuristic evaluation built on the bitboards.
+    It rewards lines of three squares that the opponent has not blocked, more so the more tiles a player already has in them, and squares where a player can make 7 right away.
+    Only proven wins and losses are saved to the transposition table, so the guesses never leak into an exact solve.
+    
+    An endgame tablebase, when loaded, answers every position within its plies at once, and its answers are exact, so a budgeted solve that reaches one never has to guess.
+    The database of earlier solves is probed the same way.
 */
 
 #ifndef NEGAMAX_H
@@ -32,52 +44,137 @@
 #endif
 
 #include <stdatomic.h>
+#include <limits.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
 
 #include "make7.h"
 #include "table.h"
 #include "result.h"
+#include "pool.h"
 
-// Enumeration for negamax scores
+// Enumeration for negamax scores; heuristic guesses lie strictly between a loss and a win
 enum NegamaxScore
 {
-    NM_DRAW, NM_WIN
+    NM_DRAW, NM_WIN = 0x10000
 };
 
-// Counter for the number of game tree nodes evaluated
-static atomic_ullong nodes;
+// Weights of the heuristic evaluation
+#define NM_EVAL_LIVE 1
+#define NM_EVAL_DOUBLE 4
+#define NM_EVAL_THREAT 32
+#define NM_EVAL_FORK 256
 
-// Array to hold the move order; the score obtained from the transposition table
-static int moveOrder[MAKE7_SIZE], tableScore;
+// How often a budgeted solve checks its limits, as a mask on a thread's node count
+#define NM_LIMIT_INTERVAL 0xfff
 
-// The transposition table object
-static TransTable table;
+// Size of a cache line; node counters are padded to it so that no two threads ever write to the same line
+#define NM_CACHE_LINE 64
 
-// The number of worker threads to use
-static int thrCount;
+// Counter for the number of game tree nodes evaluated by a single thread
+typedef struct
+{
+    atomic_ullong count;
+    char padding[NM_CACHE_LINE - sizeof(atomic_ullong)];
+}
+NodeCounter;
 
-// Negamax worker thread's parameters
+// The budget of an anytime solve; zero means no limit
 typedef struct
 {
-    Make7 m7;
-    atomic_int *running, *finishID;
-    atomic_bool *idle, *solved;
-    mtx_t *startMtx, *finishMtx;
-    cnd_t *startCnd, *finishCnd;
+    unsigned long long nodes;
+    double seconds;
+}
+NegamaxLimits;
+
+// Everything a solve shares between its threads; separate contexts can solve side by side in one process
+typedef struct
+{
+    TransTable table;                                                   // The transposition table for serial and Lazy SMP solves
+    ThreadPool *pool;                                                   // The worker threads that parallel solves queue their tasks on
+    NodeCounter *counters;                                              // One per pool worker plus one for the calling thread at index 0
+    int counterCount;                                                   // The number of node counters
+    atomic_bool stop;                                                   // Flag to unwind every search in progress; checked once per node
+    atomic_int horizon;                                                 // Iterations this deep or deeper unwind too; they cannot beat a win already proven
+    unsigned long long nodeCap;                                         // The node count at which a budgeted solve stops; zero for no limit
+    unsigned long long deadline;                                        // The monotonic time in nanoseconds at which a budgeted solve stops; zero for no limit
+    bool bestOnly;                                                      // Stop the other root moves of a parallel solve once the shortest win is proven
+    bool limited;                                                       // A budgeted solve is running, so the limits above are checked
+    bool evaluate;                                                      // Score the leaves of a depth-limited search with the heuristic evaluation instead of a draw
+    bool console;                                                       // Ctrl-C cuts a budgeted solve short; off when the solver is embedded in another program
+    const struct Tablebase *tablebase;                                  // The endgame tablebase probed at every node within its plies, if any
+    const struct Database *database;                                    // The database of positions solved by earlier runs, probed at every node, if any
+    struct Checkpoint *checkpoint;                                      // Where the serial solve and its analysis write their checkpoints, if anywhere
+}
+NegamaxContext;
+
+// The stop flag of the budgeted solve that Ctrl-C cuts short; a signal handler cannot be handed a context of its own
+static _Atomic(atomic_bool*) negamaxInterrupt;
+
+// What a single thread needs to search: its table, its own move order, and its own node counter
+typedef struct
+{
+    NegamaxContext *ctx;
     TransTable *table;
+    atomic_ullong *nodes;
+    int moveOrder[MAKE7_SIZE];
+    int rootDepth;
+}
+NegamaxThread;
+
+// Negamax root move task's parameters
+typedef struct
+{
+    Make7 m7;
+    NegamaxContext *ctx;
+    mtx_t *finishMtx;
+    cnd_t *finishCnd;
+    int *finishID, *finishCount;
     Result *results, result;
+    size_t tableSize;
     int id;
     uint8_t move;
     bool verbose;
 }
 NegamaxArgs;
 
+// Lazy SMP state shared between the main thread and its helpers
+typedef struct
+{
+    Make7 m7;
+    NegamaxContext *ctx;
+    atomic_int *mainDepth, *proofDepth, *proofScore;
+    int id, maxDepth;
+}
+NegamaxLazyArgs;
+
+// Solver context
+bool NegamaxContext_initialize(NegamaxContext*, ThreadPool*);                                           // Set up a solver context on a thread pool; the table is left to the caller
+void NegamaxContext_destroy(NegamaxContext*);                                                           // Release the node counters and the transposition table
+void NegamaxThread_initialize(NegamaxThread*, NegamaxContext*, TransTable*, const int);                 // Prepare the calling thread to search a table of the context
+unsigned long long Negamax_nodes(const NegamaxContext*);                                                // Sum the node counters of all threads
+void Negamax_resetNodes(NegamaxContext*);                                                               // Set all node counters back to zero
+void Negamax_checkLimits(NegamaxContext*);                                                              // Stop a budgeted solve that ran out of nodes or time
+
 // Negamax
-void Negamax_setColMoveOrder(void);                                                                     // Set up the move order for the columns
-bool Negamax_checkForSeven(const Make7*);                                                               // Helper function to check for a "Make 7"		
-int Negamax_search(const Make7*, TransTable*, const int, int, int);                                     // Do a negamax search on this position
-int Negamax_worker(void*);                                                                              // Negamax worker thread's main function
-Result Negamax_solve(Make7*, TransTable*, const bool);                                                  // Solve this game state and return the result
-Result Negamax_solve_parallel(Make7*, const bool, Result*, Result*, Result*, Result*, uint8_t*);        // Solve it using multiple threads
-void Negamax_results(Make7*, Result*, Result*, Result*, Result*);                                       // Get and print the results of all moves
+void Negamax_setColMoveOrder(int*);                                                                     // Set up the move order for the columns
+void Negamax_shuffleColMoveOrder(int*, const int);                                                      // Perturb the column order for a Lazy SMP helper thread
+bool Negamax_checkForSeven(const Make7*);                                                               // Helper function to check for a "Make 7"
+int Negamax_evaluate(const Make7*);                                                                     // Heuristic score of a position for the player to move
+int Negamax_known(const Result, const int);                                                             // Score a result known in advance at the remaining depth
+int Negamax_search(NegamaxThread*, const Make7*, const int, int, int);                                  // Do a negamax search on this position
+int Negamax_worker(void*);                                                                              // Negamax root move task's main function
+Result Negamax_solve(NegamaxThread*, Make7*, const bool);                                               // Solve this game state and return the result
+void Negamax_rank(Make7*, uint8_t*, int*, const uint8_t);                                               // Sort the root moves of a budgeted solve by their last score
+Result Negamax_solve_limited(NegamaxThread*, Make7*, const NegamaxLimits, uint8_t*, const bool);        // Solve it within a budget and return the best move so far
+void Negamax_generate(const NegamaxThread*, const Make7*, uint8_t*, uint8_t*);                          // Generate the moves in the order this thread searches them
+int Negamax_principalVariation(NegamaxThread*, const Make7*, const Result, uint8_t*);                   // Recover the optimal line behind a solved result
+uint8_t Negamax_drawingMove(NegamaxThread*, const Make7*);                                              // A move that keeps a drawn position drawn, found through the table
+Result Negamax_solve_parallel(NegamaxContext*, Make7*, const bool, Result*, Result*, Result*, Result*, uint8_t*); // Solve it using multiple threads
+int Negamax_lazyWorker(void*);                                                                          // Lazy SMP helper task's main function
+Result Negamax_solve_lazy(NegamaxContext*, Make7*, const bool);                                         // Solve it with threads sharing one table
+void Negamax_analyze(NegamaxContext*, Make7*, Result*, Result*, Result*);                               // Score every move together over the shared table
+void Negamax_results(NegamaxContext*, Make7*, Result*, Result*, Result*, Result*);                      // Get and print the results of all moves
 
 #endif /* NEGAMAX_H */
@@ -0,0 +1,287 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "numa.h"
+
+// Read a list like "0-3,8,10-11" into a bitmask; the number of bits set
+static int Numa_parseList(const char* restrict _LIST, unsigned long* restrict _mask)
+{
+    const char *cursor;
+    char *end;
+    unsigned long first, last;
+    int count = 0;
+    
+    memset(_mask, 0, NUMA_BITS / 8);
+    
+    for (cursor = _LIST; (*cursor >= '0') && (*cursor <= '9'); cursor = end + (*end == ','))
+    {
+        first = last = strtoul(cursor, &end, 10);
+        
+        if (*end == '-')
+        {
+            last = strtoul(end + 1, &end, 10);
+        }
+        
+        for (; (first <= last) && (first < NUMA_BITS); first++, count++)
+        {
+            _mask[first / (8 * sizeof(*_mask))] |= 1ul << (first % (8 * sizeof(*_mask)));
+        }
+    }
+    
+    return count;
+}
+
+int Numa_cpus(const char* restrict _LIST, int* restrict _cpus)
+{
+    unsigned long mask[NUMA_BITS / (8 * sizeof(unsigned long))];
+    int cpu, count = 0;
+    
+    Numa_parseList(_LIST, mask);
+    
+    for (cpu = 0; cpu < NUMA_BITS; cpu++)
+    {
+        if (mask[cpu / (8 * sizeof(*mask))] & (1ul << (cpu % (8 * sizeof(*mask)))))
+        {
+            _cpus[count++] = cpu;
+        }
+    }
+    
+    return count;
+}
+
+#ifdef __linux__
+
+// The nodes online, in the order threads are handed out to them; read once, however many threads ask first
+static int numaCount = 0;
+static int numaNode[NUMA_BITS];
+static once_flag numaOnce = ONCE_FLAG_INIT;
+
+// Read a list from a sysfs file into a bitmask; the number of bits set, or zero if it cannot be read
+static int Numa_readList(const char* restrict _PATH, unsigned long* restrict _mask)
+{
+    char list[NUMA_LIST];
+    FILE *file = fopen(_PATH, "r");
+    
+    if (!file || !fgets(list, sizeof(list), file))
+    {
+        list[0] = '\0';
+    }
+    
+    if (file)
+    {
+        fclose(file);
+    }
+    
+    return Numa_parseList(list, _mask);
+}
+
+// Nodes without memory or processors of their own still count; the kernel places their pages on the nearest node
+static void Numa_detect(void)
+{
+    unsigned long mask[NUMA_BITS / (8 * sizeof(unsigned long))];
+    int n;
+    
+    if (Numa_readList("/sys/devices/system/node/online", mask))
+    {
+        for (n = 0; n < NUMA_BITS; n++)
+        {
+            if (mask[n / (8 * sizeof(*mask))] & (1ul << (n % (8 * sizeof(*mask)))))
+            {
+                numaNode[numaCount++] = n;
+            }
+        }
+    }
+    else
+    {
+        numaNode[numaCount++] = 0;
+    }
+}
+
+int Numa_nodes(void)
+{
+    call_once(&numaOnce, Numa_detect);
+    
+    return numaCount;
+}
+
+bool Numa_interleave(void* restrict _region, const size_t _BYTES)
+{
+    unsigned long mask[NUMA_BITS / (8 * sizeof(unsigned long))] = { 0 };
+    uintptr_t page = (uintptr_t)(sysconf(_SC_PAGESIZE)), start, end;
+    int n;
+    
+    if (!_region || (Numa_nodes() < 2))
+    {
+        return false;
+    }
+    
+    for (n = 0; n < numaCount; n++)
+    {
+        mask[numaNode[n] / (8 * sizeof(*mask))] |= 1ul << (numaNode[n] % (8 * sizeof(*mask)));
+    }
+    
+    // Only whole pages have a policy; the partial ones at either end stay where they fall
+    start = ((uintptr_t)(_region) + page - 1) & ~(page - 1);
+    end = ((uintptr_t)(_region) + _BYTES) & ~(page - 1);
+    
+    return (end > start) && !syscall(SYS_mbind, start, end - start, NUMA_INTERLEAVE, mask, (unsigned long)(NUMA_BITS), 0ul);
+}
+
+bool Numa_bind(const int _NODE)
+{
+    unsigned long mask[NUMA_BITS / (8 * sizeof(unsigned long))];
+    char path[NUMA_LIST];
+    cpu_set_t cpus;
+    int cpu;
+    
+    if ((_NODE < 0) || (Numa_nodes() < 2))
+    {
+        return false;
+    }
+    
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", numaNode[_NODE % numaCount]);
+    
+    // A node of memory alone has no processors to run on
+    if (!Numa_readList(path, mask))
+    {
+        return false;
+    }
+    
+    CPU_ZERO(&cpus);
+    
+    for (cpu = 0; (cpu < NUMA_BITS) && (cpu < CPU_SETSIZE); cpu++)
+    {
+        if (mask[cpu / (8 * sizeof(*mask))] & (1ul << (cpu % (8 * sizeof(*mask)))))
+        {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    
+    // On Linux, process zero is the calling thread alone
+    return !sched_setaffinity(0, sizeof(cpus), &cpus);
+}
+
+int Numa_allowed(int* restrict _cpus)
+{
+    cpu_set_t cpus;
+    int cpu, count = 0;
+    
+    if (sched_getaffinity(0, sizeof(cpus), &cpus))
+    {
+        return 0;
+    }
+    
+    for (cpu = 0; (cpu < CPU_SETSIZE) && (cpu < NUMA_BITS); cpu++)
+    {
+        if (CPU_ISSET(cpu, &cpus))
+        {
+            _cpus[count++] = cpu;
+        }
+    }
+    
+    return count;
+}
+
+bool Numa_pin(const int _CPU)
+{
+    cpu_set_t cpus;
+    
+    if ((_CPU < 0) || (_CPU >= CPU_SETSIZE))
+    {
+        return false;
+    }
+    
+    CPU_ZERO(&cpus);
+    CPU_SET(_CPU, &cpus);
+    
+    return !sched_setaffinity(0, sizeof(cpus), &cpus);
+}
+
+bool Numa_pinAny(const int* restrict _CPUS, const int _COUNT)
+{
+    cpu_set_t cpus;
+    int cpu;
+    
+    CPU_ZERO(&cpus);
+    
+    for (cpu = 0; cpu < _COUNT; cpu++)
+    {
+        if ((_CPUS[cpu] < 0) || (_CPUS[cpu] >= CPU_SETSIZE))
+        {
+            return false;
+        }
+        
+        CPU_SET(_CPUS[cpu], &cpus);
+    }
+    
+    return _COUNT && !sched_setaffinity(0, sizeof(cpus), &cpus);
+}
+
+#else
+
+int Numa_nodes(void)
+{
+    return 1;
+}
+
+bool Numa_interleave(void* restrict _region, const size_t _BYTES)
+{
+    (void)(_region);
+    (void)(_BYTES);
+    
+    return false;
+}
+
+bool Numa_bind(const int _NODE)
+{
+    (void)(_NODE);
+    
+    return false;
+}
+
+// Without a way to ask, every processor is taken to be allowed
+int Numa_allowed(int* restrict _cpus)
+{
+    (void)(_cpus);
+    
+    return 0;
+}
+
+bool Numa_pin(const int _CPU)
+{
+#if defined(_WIN64) || defined(_WIN32)
+    // Only the first processor group can be asked for with an affinity mask
+    return (_CPU >= 0) && (_CPU < 64) && SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)(1) << _CPU);
+#else
+    (void)(_CPU);
+    
+    return false;
+#endif
+}
+
+bool Numa_pinAny(const int* restrict _CPUS, const int _COUNT)
+{
+#if defined(_WIN64) || defined(_WIN32)
+    DWORD_PTR mask = 0;
+    
+    for (int cpu = 0; cpu < _COUNT; cpu++)
+    {
+        if ((_CPUS[cpu] < 0) || (_CPUS[cpu] >= 64))
+        {
+            return false;
+        }
+        
+        mask |= (DWORD_PTR)(1) << _CPUS[cpu];
+    }
+    
+    return mask && SetThreadAffinityMask(GetCurrentThread(), mask);
+#else
+    (void)(_CPUS);
+    (void)(_COUNT);
+    
+    return false;
+#endif
+}
+
+#endif
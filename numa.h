@@ -0,0 +1,52 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    NUMA placement of the transposition table and the threads that probe it, for machines with more than one memory node.
+    A page is placed on the node of the thread that first writes to it, so a table cleared by one thread ends up on a single node.
+    The threads on every other node then reach it over the interconnect, and that one node's memory controller serves every probe.
+    
+    Tables shared by every thread are allocated untouched and interleaved page by page over all nodes, spreading the load over every controller.
+    Each pool worker is bound to the processors of one node, taking turns over the nodes, and so are the worker processes of the multi-process solvers.
+    Tables private to a worker are then first touched by it and stay on its own node.
+    Threads can instead be pinned to one processor each, so that none migrates and leaves its boards, history tables and tree nodes behind in another core's caches.
+    Everything here talks to the kernel directly through sysfs and system calls, so no NUMA library is needed; on other systems it does nothing.
+*/
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <threads.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+// Memory policy of the mbind system call that spreads pages over a set of nodes
+#define NUMA_INTERLEAVE 3
+
+// Number of nodes and processors the bitmasks hold
+#define NUMA_BITS 4096
+
+// Length of a list of nodes or processors read from sysfs
+#define NUMA_LIST 4096
+
+// Detecting the nodes
+int Numa_nodes(void);                                                                                   // Number of memory nodes; one without NUMA
+
+// Placement
+bool Numa_interleave(void*, const size_t);                                                              // Spread the untouched pages of a region over every node
+bool Numa_bind(const int);                                                                              // Run the calling thread on the processors of a node
+
+// Pinning
+int Numa_cpus(const char*, int*);                                                                       // Read a list of processors like "0-3,8"; how many there are
+int Numa_allowed(int*);                                                                                 // The processors this process may run on; zero if unknown
+bool Numa_pin(const int);                                                                               // Run the calling thread on one processor alone
+bool Numa_pinAny(const int*, const int);                                                                // Run the calling thread on whichever of some processors is free
+
+#endif /* NUMA_H */
@@ -0,0 +1,274 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "pool.h"
+
+int ThreadPool_processors(void)
+{
+    int processors = 1;
+    
+#if defined(_WIN64) || defined(_WIN32)
+    processors = GetMaximumProcessorCount(ALL_PROCESSOR_GROUPS);
+#elifdef __unix__
+    processors = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    
+    return processors > 0 ? processors : 1;
+}
+
+bool ThreadPool_initialize(ThreadPool* restrict _pool, const int _COUNT, const int* restrict _CPUS)
+{
+    int wkr, nodes;
+    PoolWorkerArgs *args;
+    
+    _pool->count = _COUNT > 0 ? _COUNT : 1;
+    atomic_init(&_pool->queued, 0);
+    atomic_init(&_pool->pending, 0);
+    atomic_init(&_pool->nextDeque, 0);
+    atomic_init(&_pool->shutdown, false);
+    
+    if (!(_pool->worker = malloc(sizeof(*_pool->worker) * _pool->count)) || !(_pool->deque = malloc(sizeof(*_pool->deque) * _pool->count)))
+    {
+        return false;
+    }
+    
+    if ((mtx_init(&_pool->idleMtx, mtx_plain) != thrd_success) || (cnd_init(&_pool->idleCnd) != thrd_success) || (cnd_init(&_pool->doneCnd) != thrd_success))
+    {
+        return false;
+    }
+    
+    // Every worker starts with an empty deque
+    for (wkr = 0; wkr < _pool->count; wkr++)
+    {
+        _pool->deque[wkr].top = _pool->deque[wkr].bottom = 0;
+        _pool->deque[wkr].capacity = POOL_DEQUE_SIZE;
+        
+        if (!(_pool->deque[wkr].task = malloc(sizeof(*_pool->deque[wkr].task) * POOL_DEQUE_SIZE)) || (mtx_init(&_pool->deque[wkr].lock, mtx_plain) != thrd_success))
+        {
+            return false;
+        }
+    }
+    
+    // Workers take turns over the NUMA nodes, so that each node's share of an interleaved table is probed by as many workers as the next
+    nodes = Numa_nodes();
+    
+    for (wkr = 0; wkr < _pool->count; wkr++)
+    {
+        // The worker frees its own arguments when it exits
+        if (!(args = malloc(sizeof(*args))))
+        {
+            return false;
+        }
+        
+        *args = (PoolWorkerArgs) {.pool = _pool, .id = wkr, .node = (nodes > 1) ? wkr % nodes : -1, .cpu = _CPUS ? _CPUS[wkr] : -1};
+        
+        if (thrd_create(&_pool->worker[wkr], ThreadPool_worker, args) != thrd_success)
+        {
+            free(args);
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void ThreadPool_destroy(ThreadPool* restrict _pool)
+{
+    int wkr;
+    
+    if (!_pool->worker)
+    {
+        return;
+    }
+    
+    ThreadPool_wait(_pool);
+    
+    // Wake up every sleeping worker so they can see the shutdown flag
+    mtx_lock(&_pool->idleMtx);
+    atomic_store(&_pool->shutdown, true);
+    cnd_broadcast(&_pool->idleCnd);
+    mtx_unlock(&_pool->idleMtx);
+    
+    for (wkr = 0; wkr < _pool->count; wkr++)
+    {
+        if (thrd_join(_pool->worker[wkr], nullptr) == thrd_error)
+        {
+            fprintf(stderr, "Could not join pool worker thread #%d.\n", wkr);
+        }
+        
+        mtx_destroy(&_pool->deque[wkr].lock);
+        free(_pool->deque[wkr].task);
+    }
+    
+    mtx_destroy(&_pool->idleMtx);
+    cnd_destroy(&_pool->idleCnd);
+    cnd_destroy(&_pool->doneCnd);
+    free(_pool->worker);
+    free(_pool->deque);
+    _pool->worker = nullptr;
+    _pool->deque = nullptr;
+}
+
+bool PoolDeque_push(PoolDeque* restrict _dq, const PoolTask _TASK)
+{
+    PoolTask *grown;
+    size_t i;
+    
+    mtx_lock(&_dq->lock);
+    
+    // Double the ring buffer when it is full, unwrapping the tasks in order
+    if (_dq->bottom - _dq->top == _dq->capacity)
+    {
+        if (!(grown = malloc(sizeof(*grown) * (_dq->capacity << 1))))
+        {
+            mtx_unlock(&_dq->lock);
+            return false;
+        }
+        
+        for (i = _dq->top; i != _dq->bottom; i++)
+        {
+            grown[i - _dq->top] = _dq->task[i % _dq->capacity];
+        }
+        
+        free(_dq->task);
+        _dq->task = grown;
+        _dq->bottom -= _dq->top;
+        _dq->top = 0;
+        _dq->capacity <<= 1;
+    }
+    
+    _dq->task[_dq->bottom++ % _dq->capacity] = _TASK;
+    mtx_unlock(&_dq->lock);
+    
+    return true;
+}
+
+bool PoolDeque_pop(PoolDeque* restrict _dq, PoolTask* restrict _task)
+{
+    bool found = false;
+    
+    mtx_lock(&_dq->lock);
+    
+    if (_dq->bottom != _dq->top)
+    {
+        *_task = _dq->task[--_dq->bottom % _dq->capacity];
+        found = true;
+    }
+    
+    mtx_unlock(&_dq->lock);
+    
+    return found;
+}
+
+bool PoolDeque_steal(PoolDeque* restrict _dq, PoolTask* restrict _task)
+{
+    bool found = false;
+    
+    mtx_lock(&_dq->lock);
+    
+    if (_dq->bottom != _dq->top)
+    {
+        *_task = _dq->task[_dq->top++ % _dq->capacity];
+        found = true;
+    }
+    
+    mtx_unlock(&_dq->lock);
+    
+    return found;
+}
+
+int ThreadPool_worker(void *_args)
+{
+    PoolWorkerArgs args = *(PoolWorkerArgs*)(_args);
+    ThreadPool *tp = args.pool;
+    PoolTask task;
+    int victim;
+    bool found;
+    
+    free(_args);
+    poolWorkerID = args.id;
+    
+    // Private tables this worker allocates are first touched here, on its own node; a pinned worker stays on its processor's
+    if (args.cpu >= 0)
+    {
+        Numa_pin(args.cpu);
+    }
+    else if (args.node >= 0)
+    {
+        Numa_bind(args.node);
+    }
+    
+    for (;;)
+    {
+        // Our own work first, newest to oldest, then the oldest work of every other worker
+        found = PoolDeque_pop(&tp->deque[args.id], &task);
+        
+        for (victim = 1; !found && (victim < tp->count); victim++)
+        {
+            found = PoolDeque_steal(&tp->deque[(args.id + victim) % tp->count], &task);
+        }
+        
+        if (found)
+        {
+            atomic_fetch_sub(&tp->queued, 1);
+            task.func(task.arg);
+            
+            // Wake up anyone waiting for the pool to drain
+            if (atomic_fetch_sub(&tp->pending, 1) == 1)
+            {
+                mtx_lock(&tp->idleMtx);
+                cnd_broadcast(&tp->doneCnd);
+                mtx_unlock(&tp->idleMtx);
+            }
+            
+            continue;
+        }
+        
+        // Sleep until there is something to do
+        mtx_lock(&tp->idleMtx);
+        
+        while (!atomic_load(&tp->queued) && !atomic_load(&tp->shutdown))
+        {
+            cnd_wait(&tp->idleCnd, &tp->idleMtx);
+        }
+        
+        mtx_unlock(&tp->idleMtx);
+        
+        if (atomic_load(&tp->shutdown) && !atomic_load(&tp->queued))
+        {
+            return 0;
+        }
+    }
+}
+
+void ThreadPool_submit(ThreadPool* restrict _pool, int (*_func)(void*), void *_arg)
+{
+    // Workers keep their spawned tasks close; everyone else deals them out in turn
+    int target = (poolWorkerID >= 0) ? poolWorkerID : (int)(atomic_fetch_add(&_pool->nextDeque, 1) % _pool->count);
+    
+    atomic_fetch_add(&_pool->pending, 1);
+    
+    if (!PoolDeque_push(&_pool->deque[target], (PoolTask) {_func, _arg}))
+    {
+        fprintf(stderr, "Could not queue a task on pool worker #%d.\n", target);
+        exit(EXIT_FAILURE);
+    }
+    
+    mtx_lock(&_pool->idleMtx);
+    atomic_fetch_add(&_pool->queued, 1);
+    cnd_signal(&_pool->idleCnd);
+    mtx_unlock(&_pool->idleMtx);
+}
+
+void ThreadPool_wait(ThreadPool* restrict _pool)
+{
+    mtx_lock(&_pool->idleMtx);
+    
+    while (atomic_load(&_pool->pending))
+    {
+        cnd_wait(&_pool->doneCnd, &_pool->idleMtx);
+    }
+    
+    mtx_unlock(&_pool->idleMtx);
+}
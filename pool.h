@@ -0,0 +1,87 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    A persistent thread pool shared by the negamax and Monte Carlo tree search engines.
+    The worker threads are created once when the solver starts and sleep between searches, so short solves do not pay for thread creation.
+    
+    Each worker owns a double-ended queue of tasks. It pushes and pops its own tasks at the bottom, the most recently added first.
+    When a worker runs out of tasks, it steals from the top of another worker's queue, the oldest task first, to keep every core busy.
+    The queues are short and only touched when a task starts or ends, so a plain mutex per queue is enough to keep them consistent.
+*/
+
+#ifndef POOL_H
+#define POOL_H
+
+#if (defined(__MINGW32__) || defined(__MINGW64__))
+#include "mingw_threads.h"
+#else
+#include <threads.h>
+#endif
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "numa.h"
+
+#define POOL_DEQUE_SIZE 64
+
+// A unit of work; same signature as a C11 thread's main function
+typedef struct
+{
+    int (*func)(void*);
+    void *arg;
+}
+PoolTask;
+
+// A worker's double-ended queue as a growable ring buffer
+typedef struct
+{
+    PoolTask *task;
+    size_t top, bottom, capacity;
+    mtx_t lock;
+}
+PoolDeque;
+
+// The thread pool itself
+typedef struct ThreadPool
+{
+    thrd_t *worker;
+    PoolDeque *deque;
+    atomic_int queued, pending;
+    atomic_uint nextDeque;
+    atomic_bool shutdown;
+    mtx_t idleMtx;
+    cnd_t idleCnd, doneCnd;
+    int count;
+}
+ThreadPool;
+
+// Worker thread's parameters
+typedef struct
+{
+    ThreadPool *pool;
+    int id;
+    int node;                                                           // The NUMA node it runs on, or -1 to run anywhere
+    int cpu;                                                            // The processor it is pinned to, or -1 if it is not
+}
+PoolWorkerArgs;
+
+// Identifies the pool worker running on this thread, or -1 for any other thread
+static thread_local int poolWorkerID = -1;
+
+// Memory management
+int ThreadPool_processors(void);                                                                        // Get the number of online logical processors
+bool ThreadPool_initialize(ThreadPool*, const int, const int*);                                         // Start the worker threads, pinned to a processor each if given
+void ThreadPool_destroy(ThreadPool*);                                                                   // Finish outstanding tasks and join the workers
+
+// Deque operations
+bool PoolDeque_push(PoolDeque*, const PoolTask);                                                        // Push a task to the bottom
+bool PoolDeque_pop(PoolDeque*, PoolTask*);                                                              // Pop a task from the bottom; used by the owner
+bool PoolDeque_steal(PoolDeque*, PoolTask*);                                                            // Take a task from the top; used by thieves
+
+// Scheduling
+int ThreadPool_worker(void*);                                                                           // Worker thread's main function
+void ThreadPool_submit(ThreadPool*, int (*)(void*), void*);                                             // Queue a task to run on the pool
+void ThreadPool_wait(ThreadPool*);                                                                      // Wait for every submitted task to finish
+
+#endif /* POOL_H */
@@ -0,0 +1,255 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "position.h"
+
+void Position_encode(const Make7* restrict _M7, PositionCode* restrict _code)
+{
+    uint64_t word[3] = {0, 0, 0}, bit;
+    int col, cell, value, i;
+    
+    // Only the squares below each column's height hold anything
+    for (col = 0; col < MAKE7_SIZE; col++)
+    {
+        for (bit = MAKE7_SIZE_P1 * col, cell = MAKE7_SIZE * col; bit < _M7->height[col]; bit++, cell++)
+        {
+            value = 1 + ((_M7->tiles23[0] >> bit) & 1) + 2 * ((_M7->tiles23[1] >> bit) & 1) + 3 * ((_M7->player[1] >> bit) & 1);
+            word[cell / MAKE7_SIZE_X3] |= (uint64_t)(value) << (3 * (cell % MAKE7_SIZE_X3));
+        }
+    }
+    
+    word[2] |= ((uint64_t)(_M7->remaining[0]) << 21) | ((uint64_t)(_M7->remaining[1]) << 29) | ((uint64_t)(_M7->remaining[2]) << 37) | ((uint64_t)(_M7->lastTile & 7) << 45) | ((uint64_t)(_M7->turn) << 48);
+    
+    for (i = 0; i < POS_BYTES; i++)
+    {
+        _code->byte[i] = (uint8_t)(word[i >> 3] >> ((i & 7) << 3));
+    }
+}
+
+bool Position_decode(const PositionCode* restrict _CODE, Make7* restrict _m7)
+{
+    uint64_t word[3] = {0, 0, 0}, bit;
+    int col, row, cell, value, tile, owner, placed[2][3] = {{0, 0, 0}, {0, 0, 0}}, ply = 0, i;
+    uint8_t start[3];
+    bool empty;
+    
+    for (i = 0; i < POS_BYTES; i++)
+    {
+        word[i >> 3] |= (uint64_t)(_CODE->byte[i]) << ((i & 7) << 3);
+    }
+    
+    // The top bit of each word and everything after the side to move are never set
+    if ((word[0] >> 63) || (word[1] >> 63) || (word[2] >> 49))
+    {
+        return false;
+    }
+    
+    Make7_initialize(_m7);
+    memcpy(start, _m7->remaining, sizeof(start));
+    
+    for (col = 0; col < MAKE7_SIZE; col++)
+    {
+        for (row = 0, empty = false; row < MAKE7_SIZE; row++)
+        {
+            cell = MAKE7_SIZE * col + row;
+            value = (word[cell / MAKE7_SIZE_X3] >> (3 * (cell % MAKE7_SIZE_X3))) & 7;
+            
+            // Tiles cannot float above an empty square
+            if (!value)
+            {
+                empty = true;
+                continue;
+            }
+            
+            bit = MAKE7_SIZE_P1 * col + row;
+            owner = value > 3;
+            tile = value - 3 * owner;
+            
+            if (empty || (value > 6) || ((tile == 3) && !((1ull << bit) & MAKE7_THREES)))
+            {
+                return false;
+            }
+            
+            _m7->player[owner] |= 1ull << bit;
+            
+            if (tile > 1)
+            {
+                _m7->tiles23[tile - 2] |= 1ull << bit;
+            }
+            
+            _m7->height[col]++;
+            placed[owner][tile - 1]++;
+            ply++;
+        }
+    }
+    
+    _m7->remaining[0] = (uint8_t)(word[2] >> 21);
+    _m7->remaining[1] = (uint8_t)(word[2] >> 29);
+    _m7->remaining[2] = (uint8_t)(word[2] >> 37);
+    _m7->lastTile = (word[2] >> 45) & 7;
+    _m7->turn = (word[2] >> 48) & 1;
+    
+    // Every tile a player started with is either on the board or left over, and the players took turns
+    for (tile = 0; tile < 3; tile++)
+    {
+        if (((_m7->remaining[tile] & 0xf) + placed[0][tile] != (start[tile] & 0xf)) || ((_m7->remaining[tile] >> 4) + placed[1][tile] != (start[tile] >> 4)))
+        {
+            return false;
+        }
+    }
+    
+    if ((_m7->lastTile >= MAKE7_SIZE) || (_m7->turn != (ply & 1)))
+    {
+        return false;
+    }
+    
+    // The last drop is on top of its column and was made by the player who just moved; before any, it is left at column A
+    if (!ply)
+    {
+        return !_m7->lastTile;
+    }
+    
+    col = _m7->lastTile;
+    
+    return (_m7->height[col] > MAKE7_SIZE_P1 * col) && ((_m7->player[!_m7->turn] >> (_m7->height[col] - 1)) & 1);
+}
+
+void Position_toText(const Make7* restrict _M7, char* restrict _text)
+{
+    uint64_t bit;
+    int col, tile;
+    
+    for (col = 0; col < MAKE7_SIZE; col++)
+    {
+        for (bit = MAKE7_SIZE_P1 * col; bit < _M7->height[col]; bit++)
+        {
+            tile = 1 + ((_M7->tiles23[0] >> bit) & 1) + 2 * ((_M7->tiles23[1] >> bit) & 1);
+            *_text++ = ((_M7->player[1] >> bit) & 1) ? 'a' + tile - 1 : '0' + tile;
+        }
+        
+        if (col < MAKE7_SIZE_M1)
+        {
+            *_text++ = '/';
+        }
+    }
+    
+    sprintf(_text, " %d %d,%d,%d %d,%d,%d %c", 1 + _M7->turn, _M7->remaining[0] & 0xf, _M7->remaining[1] & 0xf, _M7->remaining[2] & 0xf,
+            _M7->remaining[0] >> 4, _M7->remaining[1] >> 4, _M7->remaining[2] >> 4, 'A' + (_M7->lastTile & 7));
+}
+
+bool Position_fromText(const char* restrict _TEXT, Make7* restrict _m7)
+{
+    PositionCode code;
+    unsigned left[6];
+    char side, last;
+    int col, row, length;
+    uint64_t bit;
+    
+    Make7_initialize(_m7);
+    
+    // The squares first; at most seven tiles to a column, so none spills into the next
+    for (col = 0; col < MAKE7_SIZE; col++)
+    {
+        for (row = 0; ((*_TEXT >= '1') && (*_TEXT <= '3')) || ((*_TEXT >= 'a') && (*_TEXT <= 'c')); row++, _TEXT++)
+        {
+            if (row == MAKE7_SIZE)
+            {
+                return false;
+            }
+            
+            bit = 1ull << _m7->height[col]++;
+            _m7->player[*_TEXT >= 'a'] |= bit;
+            
+            if ((*_TEXT == '2') || (*_TEXT == 'b'))
+            {
+                _m7->tiles23[0] |= bit;
+            }
+            else if ((*_TEXT == '3') || (*_TEXT == 'c'))
+            {
+                _m7->tiles23[1] |= bit;
+            }
+        }
+        
+        if ((col < MAKE7_SIZE_M1) && (*_TEXT++ != '/'))
+        {
+            return false;
+        }
+    }
+    
+    length = 0;
+    
+    if ((sscanf(_TEXT, " %c %u,%u,%u %u,%u,%u %c%n", &side, &left[0], &left[1], &left[2], &left[3], &left[4], &left[5], &last, &length) != 8) || _TEXT[length]
+        || ((side != '1') && (side != '2')) || (last < 'A') || (last > 'G'))
+    {
+        return false;
+    }
+    
+    for (col = 0; col < 3; col++)
+    {
+        if ((left[col] > 0xf) || (left[col + 3] > 0xf))
+        {
+            return false;
+        }
+        
+        _m7->remaining[col] = (uint8_t)(left[col] | (left[col + 3] << 4));
+    }
+    
+    _m7->turn = side == '2';
+    _m7->lastTile = last - 'A';
+    
+    // Whatever the binary form would turn down is turned down here as well
+    Position_encode(_m7, &code);
+    
+    return Position_decode(&code, _m7);
+}
+
+size_t Position_write(FILE* restrict _out, const Make7* restrict _M7, const size_t _COUNT)
+{
+    PositionCode code[POS_CHUNK];
+    size_t done, chunk, i;
+    
+    for (done = 0; done < _COUNT; done += chunk)
+    {
+        chunk = (_COUNT - done < POS_CHUNK) ? _COUNT - done : POS_CHUNK;
+        
+        for (i = 0; i < chunk; i++)
+        {
+            Position_encode(&_M7[done + i], &code[i]);
+        }
+        
+        if ((i = fwrite(code, sizeof(*code), chunk, _out)) != chunk)
+        {
+            return done + i;
+        }
+    }
+    
+    return done;
+}
+
+size_t Position_read(FILE* restrict _in, Make7* restrict _m7, const size_t _COUNT)
+{
+    PositionCode code[POS_CHUNK];
+    size_t done, chunk, got, i;
+    
+    for (done = 0; done < _COUNT; done += got)
+    {
+        chunk = (_COUNT - done < POS_CHUNK) ? _COUNT - done : POS_CHUNK;
+        got = fread(code, sizeof(*code), chunk, _in);
+        
+        for (i = 0; i < got; i++)
+        {
+            if (!Position_decode(&code[i], &_m7[done + i]))
+            {
+                return done + i;
+            }
+        }
+        
+        if (got < chunk)
+        {
+            return done + got;
+        }
+    }
+    
+    return done;
+}
@@ -0,0 +1,54 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    Positions in a fixed-size binary form and a short text form, for tools that exchange positions in bulk without replaying move sequences.
+    
+    The binary form is 24 bytes: three 64-bit words, each written least significant byte first, so it reads the same on any machine.
+    The 49 squares take three bits each, column by column from the bottom, 21 to a word: zero when empty, 1 to 3 for the first player's tiles and 4 to 6 for the second's.
+    The last word then holds the tiles each player has left, as the three bytes of remaining[], the column of the last drop in three bits, and the side to move in one.
+    
+    The text form is like FEN in chess: the columns from A to G, each from the bottom up, separated by slashes, with the first player's tiles as 1 to 3 and the second's as a to c.
+    The side to move, 1 or 2, the tiles each player has left, ones, twos and threes, and the column of the last drop follow, separated by spaces.
+    The starting position is "////// 1 11,11,4 11,11,4 A", and the one after 2D 2D 2C 2D is "//2/2bb/// 1 11,9,4 11,9,4 D".
+    
+    A position is only taken if the game could reach it: no floating tiles, threes only on their squares, every tile either on the board or left over, and the last drop on top of its column by the player who just made it.
+*/
+
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "make7.h"
+
+// Bytes in the binary form
+#define POS_BYTES 24
+
+// Longest text form, with its terminator
+#define POS_TEXT 80
+
+// Positions converted at a time by the bulk reader and writer
+#define POS_CHUNK 1024
+
+// The binary form of a position; every member is a single byte, so there is no padding or byte order
+typedef struct
+{
+    uint8_t byte[POS_BYTES];
+}
+PositionCode;
+
+// Binary form
+void Position_encode(const Make7*, PositionCode*);                                                      // Pack a position into its binary form
+bool Position_decode(const PositionCode*, Make7*);                                                      // Unpack a position; false if the game could not reach it
+
+// Text form
+void Position_toText(const Make7*, char*);                                                              // Write a position in its text form, at most POS_TEXT bytes
+bool Position_fromText(const char*, Make7*);                                                            // Read a position from its text form; false if it is not one
+
+// Bulk input and output
+size_t Position_write(FILE*, const Make7*, const size_t);                                               // Write positions in their binary form; how many were written
+size_t Position_read(FILE*, Make7*, const size_t);                                                      // Read positions in their binary form; fewer at the end or at one that is not valid
+
+#endif /* POSITION_H */
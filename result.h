@@ -19,6 +19,7 @@
 #define DRAW_TEXT "DRAW"
 #define NONE_TEXT "-- "
 #define RESULT_DRAW (Result) { DRAW_CHAR, -1 }
+#define RESULT_UNKNOWN (Result) { UNKNOWN_CHAR, 0 }
 
 // Enumeration for the result of the game: unknown, win, draw, and loss
 typedef enum
@@ -0,0 +1,349 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "server.h"
+
+enum ServerStatus Server_answer(Server* restrict _sv, Make7* restrict _m7, const bool _ALL, ServerReply* restrict _reply)
+{
+    NegamaxThread *nt = _sv->thread;
+    Result r1[MAKE7_SIZE], r2[MAKE7_SIZE], r3[MAKE7_SIZE];
+    uint8_t line[MAKE7_AREA], tile, col;
+    int length = 0;
+    
+    _reply->best = 0;
+    _reply->result = RESULT_UNKNOWN;
+    
+    for (col = 0; col < MAKE7_SIZE_X3; col++)
+    {
+        _reply->moves[col] = RESULT_UNKNOWN;
+    }
+    
+    if (Make7_gameOver(_m7) || Make7_gridFull(_m7))
+    {
+        return (_reply->status = SV_OVER);
+    }
+    
+    // A budget leaves the moves other than the best one unsettled
+    if (_ALL && _sv->limited)
+    {
+        return (_reply->status = SV_EXACT);
+    }
+    
+    Negamax_resetNodes(nt->ctx);
+    
+    // The book answers at once; an exact solve only takes a proven result from it, and it holds nothing about the other moves
+    if (!_ALL && Book_probe(_sv->book, _m7, &_reply->best, &_reply->result) && (_sv->limited || (_reply->result.wdl != UNKNOWN_CHAR)))
+    {
+        return (_reply->status = SV_OK);
+    }
+    
+    if (_sv->limited)
+    {
+        _reply->result = Negamax_solve_limited(nt, _m7, _sv->limits, &_reply->best, false);
+    }
+    else if (_sv->parallel)
+    {
+        _reply->result = Negamax_solve_parallel(nt->ctx, _m7, false, r1, r2, r3, nullptr, &_reply->best);
+    }
+    else
+    {
+        if (!(_sv->database && Database_load(_sv->database, _m7, &_reply->result)))
+        {
+            _reply->result = _sv->lazySMP ? Negamax_solve_lazy(nt->ctx, _m7, false) : Negamax_solve(nt, _m7, false);
+        }
+        
+        length = Negamax_principalVariation(nt, _m7, _reply->result, line);
+        
+        if (_sv->database)
+        {
+            Database_storeLine(_sv->database, _m7, _reply->result, line, length);
+        }
+        
+        if (_ALL)
+        {
+            Negamax_analyze(nt->ctx, _m7, r1, r2, r3);
+        }
+        
+        _reply->best = length ? line[0] : _ALL ? Result_getBestMove(r1, r2, r3) : Negamax_drawingMove(nt, _m7);
+    }
+    
+    for (tile = 0; _ALL && (tile < 3); tile++)
+    {
+        for (col = 0; col < MAKE7_SIZE; col++)
+        {
+            _reply->moves[tile * MAKE7_SIZE + col] = (tile == 0) ? r1[col] : (tile == 1) ? r2[col] : r3[col];
+        }
+    }
+    
+    return (_reply->status = SV_OK);
+}
+
+// Write a result as it is shown after a solve, without colors; a move that was not settled is a dash
+static inline void Server_writeResult(FILE* restrict _out, const Result _R)
+{
+    if ((_R.wdl == WIN_CHAR) || (_R.wdl == LOSS_CHAR))
+    {
+        fprintf(_out, "%c%d", _R.wdl, _R.dt7);
+    }
+    else
+    {
+        fputc((_R.wdl == DRAW_CHAR) ? DRAW_CHAR : '-', _out);
+    }
+}
+
+void Server_serve(Server* restrict _sv, FILE* restrict _in, FILE* restrict _out)
+{
+    char query[MAKE7_AREA_X2 + 3], *sequence, *end;
+    uint8_t moves[MAKE7_AREA];
+    ServerReply reply;
+    Make7 m7;
+    int c, count, mv;
+    bool all, valid;
+    
+    while ((c = getc(_in)) != EOF)
+    {
+        Make7_initialize(&m7);
+        
+        if (c == SV_BINARY)
+        {
+            // A count too large leaves no way to tell where the next query starts, so the client is hung up on after the answer
+            if ((c = getc(_in)) == EOF)
+            {
+                break;
+            }
+            
+            all = c & SV_ALL;
+            count = c & ~SV_ALL;
+            valid = (count <= MAKE7_AREA) && (fread(moves, 1, count, _in) == (size_t)(count));
+            
+            for (mv = 0; valid && (mv < count); mv++)
+            {
+                valid = !Make7_gameOver(&m7) && ((moves[mv] >> 4) >= 1) && ((moves[mv] >> 4) <= 3) && ((moves[mv] & 0xf) < MAKE7_SIZE) && Make7_drop(&m7, moves[mv] >> 4, moves[mv] & 0xf);
+            }
+            
+            if (!valid)
+            {
+                reply = (ServerReply) {.status = SV_INVALID};
+            }
+            else
+            {
+                Server_answer(_sv, &m7, all, &reply);
+            }
+            
+            if ((fwrite(&reply, sizeof(reply), 1, _out) != 1) || fflush(_out) || (count > MAKE7_AREA))
+            {
+                break;
+            }
+            
+            continue;
+        }
+        
+        ungetc(c, _in);
+        
+        // A line too long for any game is thrown away up to its end
+        if (!fgets(query, sizeof(query), _in))
+        {
+            break;
+        }
+        
+        if (!strchr(query, '\n') && !feof(_in))
+        {
+            while (((c = getc(_in)) != EOF) && (c != '\n'));
+            fputs("E The move sequence is too long.\n", _out);
+        }
+        else
+        {
+            for (end = query + strlen(query); (end > query) && ((end[-1] == '\n') || (end[-1] == '\r') || (end[-1] == ' ')); *--end = '\0');
+            
+            all = (query[0] == '+');
+            sequence = query + all;
+            
+            // A tile without its column is not a move either
+            if (!Make7_sequence(&m7, sequence) || g_inputReadyFlag)
+            {
+                fprintf(_out, "E Could not play the move sequence \"%s\".\n", sequence);
+            }
+            else
+            {
+                switch (Server_answer(_sv, &m7, all, &reply))
+                {
+                case SV_OVER:
+                    fputs("E The game is over.\n", _out);
+                    break;
+                case SV_EXACT:
+                    fputs("E The result of every move needs an exact solve; please leave out -T and -N.\n", _out);
+                    break;
+                default:
+                    // A budget that ran out shows how many plies are free of a forced result, as after a solve
+                    if (reply.result.wdl == UNKNOWN_CHAR)
+                    {
+                        fprintf(_out, "%c%d", UNKNOWN_CHAR, reply.result.dt7);
+                    }
+                    else
+                    {
+                        Server_writeResult(_out, reply.result);
+                    }
+                    
+                    reply.best ? fprintf(_out, " %d%c", reply.best >> 4, 'A' + (reply.best & 0xf)) : fputs(" -", _out);
+                    
+                    for (mv = 0; all && (mv < MAKE7_SIZE_X3); mv++)
+                    {
+                        fputc(' ', _out);
+                        Server_writeResult(_out, reply.moves[mv]);
+                    }
+                    
+                    fputc('\n', _out);
+                    break;
+                }
+            }
+        }
+        
+        if (fflush(_out))
+        {
+            break;
+        }
+    }
+}
+
+#ifdef __unix__
+// Remove the socket when terminated, then terminate as usual
+static inline void Server_terminate(int _SIGNAL)
+{
+    const char *path = atomic_load(&serverPath);
+    
+    if (path)
+    {
+        unlink(path);
+    }
+    
+    signal(_SIGNAL, SIG_DFL);
+    raise(_SIGNAL);
+}
+
+bool Server_open(Server* restrict _sv, const char* restrict _PATH)
+{
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    struct stat status;
+    int probe;
+    
+    _sv->path = _PATH;
+    _sv->listener = -1;
+    
+    if (strlen(_PATH) >= sizeof(address.sun_path))
+    {
+        return false;
+    }
+    
+    strcpy(address.sun_path, _PATH);
+    
+    // A socket left over by a run that was killed is replaced; one a server still answers on, or any other file, is not
+    if (!lstat(_PATH, &status))
+    {
+        if (!S_ISSOCK(status.st_mode) || ((probe = socket(AF_UNIX, SOCK_STREAM, 0)) < 0))
+        {
+            return false;
+        }
+        
+        if (!connect(probe, (struct sockaddr*)(&address), sizeof(address)) || unlink(_PATH))
+        {
+            close(probe);
+            return false;
+        }
+        
+        close(probe);
+    }
+    
+    if ((_sv->listener = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+    {
+        return false;
+    }
+    
+    if (bind(_sv->listener, (struct sockaddr*)(&address), sizeof(address)) || listen(_sv->listener, SV_BACKLOG))
+    {
+        close(_sv->listener);
+        _sv->listener = -1;
+        return false;
+    }
+    
+    // A client that hangs up before its answer is written must not take the server down with it
+    atomic_store(&serverPath, _PATH);
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGTERM, Server_terminate);
+    signal(SIGINT, Server_terminate);
+    
+    return true;
+}
+
+void Server_close(Server* restrict _sv)
+{
+    if (_sv->listener >= 0)
+    {
+        atomic_store(&serverPath, nullptr);
+        close(_sv->listener);
+        unlink(_sv->path);
+        _sv->listener = -1;
+    }
+}
+
+void Server_run(Server* restrict _sv)
+{
+    FILE *in, *out;
+    int client, copy;
+    
+    for (;;)
+    {
+        if ((client = accept(_sv->listener, nullptr, nullptr)) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            
+            fprintf(stderr, "Could not accept a client on \"%s\".\n", _sv->path);
+            return;
+        }
+        
+        // Reading and writing through one stream would need a seek between the two, so each gets its own descriptor
+        in = fdopen(client, "rb");
+        out = ((copy = dup(client)) >= 0) ? fdopen(copy, "wb") : nullptr;
+        
+        if (in && out)
+        {
+            Server_serve(_sv, in, out);
+        }
+        
+        in ? fclose(in) : close(client);
+        
+        if (out)
+        {
+            fclose(out);
+        }
+        else if (copy >= 0)
+        {
+            close(copy);
+        }
+    }
+}
+
+#else
+// Without Unix domain sockets, there is nothing to listen on
+bool Server_open(Server* restrict _sv, const char* restrict _PATH)
+{
+    _sv->path = _PATH;
+    _sv->listener = -1;
+    
+    return false;
+}
+
+void Server_close(Server* restrict _sv)
+{
+    (void)(_sv);
+}
+
+void Server_run(Server* restrict _sv)
+{
+    (void)(_sv);
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    The server keeps one solver running behind a Unix domain socket, so that a front end making many small queries does not start a new one each time.
+    The transposition table, opening book, database and worker threads are set up once and stay warm between queries; the table is never cleared.
+    Clients are served one at a time, in the order they connect, and each may send any number of queries before hanging up.
+    
+    A text query is a line holding a move sequence as it would be typed on standard input; an empty line is the starting position.
+    It is answered with a line holding the result and the best move, such as "W14 3D"; a draw is "D" and a move unknown is "-".
+    A plus sign before the sequence asks for the result of every move as well, seven per tile in the order of the rows printed after a solve.
+    A query that cannot be answered gets a line starting with "E" and the reason.
+    
+    A binary query starts with a byte of all ones, then the number of moves, with its top bit set to ask for every move, then one byte per move.
+    Each move byte holds the tile in its upper four bits and the column in its lower four, as moves are kept everywhere else in the solver.
+    It is answered with a ServerReply, whose status is one of the codes below; every member is a single byte, so there is no padding or byte order.
+*/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <stdatomic.h>
+
+#ifdef __unix__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+#include "make7.h"
+#include "result.h"
+#include "negamax.h"
+#include "book.h"
+#include "database.h"
+
+// The socket when none is given
+#define SV_PATH "make7.sock"
+
+// The first byte of a binary query, which no move sequence starts with
+#define SV_BINARY 0xff
+
+// Set in the count of moves of a binary query to ask for the result of every move
+#define SV_ALL 0x80
+
+// How many clients may wait to be served
+#define SV_BACKLOG 64
+
+// Status of an answer
+enum ServerStatus
+{
+    SV_OK, SV_INVALID, SV_OVER, SV_EXACT
+};
+
+// The answer to a binary query
+typedef struct
+{
+    uint8_t status;                                                     // One of the codes above; nothing else is set unless it is SV_OK
+    uint8_t best;                                                       // The best move, or zero if there is none
+    Result result;                                                      // The result of the position for the side to move
+    Result moves[MAKE7_SIZE_X3];                                        // The result of every move by tile and column if asked for; unknown otherwise
+}
+ServerReply;
+
+// Everything the server answers with
+typedef struct
+{
+    const char *path;                                                   // The socket's file
+    int listener;                                                       // The socket clients connect to
+    NegamaxThread *thread;                                              // The thread that solves, and its context with the table kept between queries
+    const Book *book;                                                   // Positions answered without searching
+    Database *database;                                                 // Positions solved before, and where new solves are kept; may be null
+    NegamaxLimits limits;                                               // The budget of a limited solve
+    bool limited, parallel, lazySMP;                                    // How to solve; an exact serial solve by default
+}
+Server;
+
+// The socket of the server running; a signal handler cannot be handed one of its own
+static _Atomic(const char*) serverPath;
+
+// Setting up
+bool Server_open(Server*, const char*);                                                                 // Listen on a socket, replacing one left over by an earlier run
+void Server_close(Server*);                                                                             // Stop listening and remove the socket
+
+// Answering
+enum ServerStatus Server_answer(Server*, Make7*, const bool, ServerReply*);                             // Solve a position, with every move if asked
+void Server_serve(Server*, FILE*, FILE*);                                                               // Answer one client's queries until it hangs up
+void Server_run(Server*);                                                                               // Answer every client that connects, one after another
+
+#endif /* SERVER_H */
@@ -0,0 +1,416 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "shared.h"
+
+#ifdef __unix__
+bool Shared_open(Shared* restrict _sh, const char* restrict _NAME, const size_t _SIZE, const bool _CREATE)
+{
+    struct stat status;
+    void *map;
+    int fd;
+    bool valid;
+    
+    _sh->header = nullptr;
+    _sh->table = (TransTable) { nullptr, 0 };
+    _sh->name = _NAME;
+    _sh->bytes = SH_ALIGN + _SIZE * sizeof(TT_Entry);
+    
+    if (((fd = shm_open(_NAME, O_RDWR | (_CREATE ? O_CREAT : 0), 0600)) < 0) || fstat(fd, &status))
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        
+        return false;
+    }
+    
+    // A segment of another size is started over; truncating it first clears whatever it held
+    if (_CREATE && ((size_t)(status.st_size) != _sh->bytes) && (ftruncate(fd, 0) || ftruncate(fd, _sh->bytes)))
+    {
+        close(fd);
+        return false;
+    }
+    
+    _sh->bytes = _CREATE ? _sh->bytes : (size_t)(status.st_size);
+    map = (_sh->bytes >= SH_ALIGN) ? mmap(nullptr, _sh->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+    
+    // Every process probes the table, so its pages are spread over the NUMA nodes before the first of them is written to
+    if (_CREATE)
+    {
+        Numa_interleave((char*)(map) + SH_ALIGN, _sh->bytes - SH_ALIGN);
+    }
+    
+    _sh->header = map;
+    valid = !memcmp(_sh->header->magic, SH_MAGIC, 4) && (_sh->header->version == SH_VERSION) && (_sh->bytes == SH_ALIGN + _sh->header->size * sizeof(TT_Entry));
+    
+    // Joining needs a segment already set up; creating one keeps the table of a valid segment left over, and clears anything else
+    if (!valid && !_CREATE)
+    {
+        Shared_close(_sh, false);
+        return false;
+    }
+    
+    if (!valid)
+    {
+        memset(map, 0, _sh->bytes);
+        memcpy(_sh->header->magic, SH_MAGIC, 4);
+        _sh->header->version = SH_VERSION;
+        _sh->header->size = _SIZE;
+    }
+    
+    if (_CREATE)
+    {
+        atomic_store(&_sh->header->count, 0);
+        atomic_store(&_sh->header->closed, false);
+    }
+    
+    _sh->table.entry = (TT_Entry*)((char*)(map) + SH_ALIGN);
+    _sh->table.size = _sh->header->size;
+    
+    return true;
+}
+
+void Shared_close(Shared* restrict _sh, const bool _REMOVE)
+{
+    if (_sh->header)
+    {
+        // Let the workers that joined know that nothing more is coming
+        if (_REMOVE)
+        {
+            atomic_store(&_sh->header->closed, true);
+            shm_unlink(_sh->name);
+        }
+        
+        munmap(_sh->header, _sh->bytes);
+    }
+    
+    _sh->header = nullptr;
+    _sh->table = (TransTable) { nullptr, 0 };
+}
+
+int Shared_post(Shared* restrict _sh, const Make7* restrict _ROOT)
+{
+    SharedHeader *header = _sh->header;
+    uint8_t list[MAKE7_SIZE_X3], total;
+    bool mirror = Make7_symmetrical(_ROOT);
+    int count = 0, left = 0;
+    
+    // Nobody can claim a move while the queue is being filled
+    atomic_store(&header->count, 0);
+    Make7_generate(_ROOT, list, &total);
+    
+    for (uint8_t mv = 0; mv < total; mv++)
+    {
+        SharedTask *task = &header->task[count];
+        
+        // Moves on the right half of a symmetrical grid score the same as their mirror images on the left
+        if (mirror && ((list[mv] & 0xf) > (MAKE7_SIZE >> 1)))
+        {
+            continue;
+        }
+        
+        task->m7 = *_ROOT;
+        task->move = list[mv];
+        Make7_drop(&task->m7, list[mv] >> 4, list[mv] & 0xf);
+        atomic_store(&task->nodes, 0);
+        
+        // Making 7 right away needs no search
+        if (Make7_tilesSumTo7(&task->m7))
+        {
+            task->result = (Result) { WIN_CHAR, 0 };
+            atomic_store(&task->owner, SH_DONE);
+        }
+        else
+        {
+            task->result = RESULT_UNKNOWN;
+            atomic_store(&task->owner, SH_PENDING);
+            left++;
+        }
+        
+        count++;
+    }
+    
+    atomic_store(&header->count, count);
+    
+    return left;
+}
+
+bool Shared_claim(Shared* restrict _sh, int* restrict _task)
+{
+    int count = atomic_load(&_sh->header->count), pending;
+    
+    for (int i = 0; i < count; i++)
+    {
+        pending = SH_PENDING;
+        
+        if (atomic_compare_exchange_strong(&_sh->header->task[i].owner, &pending, getpid()))
+        {
+            *_task = i;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+int Shared_reclaim(Shared* restrict _sh)
+{
+    int count = atomic_load(&_sh->header->count), reclaimed = 0, owner;
+    
+    // A process that no longer exists will never finish its move
+    for (int i = 0; i < count; i++)
+    {
+        if (((owner = atomic_load(&_sh->header->task[i].owner)) > 0) && kill(owner, 0) && (errno == ESRCH))
+        {
+            reclaimed += atomic_compare_exchange_strong(&_sh->header->task[i].owner, &owner, SH_PENDING);
+        }
+    }
+    
+    return reclaimed;
+}
+
+bool Shared_work(Shared* restrict _sh, NegamaxContext* restrict _ctx, const bool _JOINED)
+{
+    struct timespec nap = { .tv_nsec = 10000000 };
+    NegamaxThread worker;
+    unsigned long long nodes;
+    SharedTask *task;
+    Result result;
+    int i;
+    
+    NegamaxThread_initialize(&worker, _ctx, &_sh->table, 0);
+    
+    // Workers started by the solving process leave once the queue is empty; those that joined wait for the next position
+    while (!atomic_load(&_sh->header->closed))
+    {
+        if (!Shared_claim(_sh, &i))
+        {
+            if (!_JOINED)
+            {
+                break;
+            }
+            
+            thrd_sleep(&nap, nullptr);
+            continue;
+        }
+        
+        task = &_sh->header->task[i];
+        nodes = Negamax_nodes(_ctx);
+        result = Negamax_solve(&worker, &task->m7, false);
+        Result_increment(&result);
+        
+        // The result is written before the move is marked done, so whoever sees it done sees the result too
+        task->result = result;
+        atomic_store(&task->nodes, Negamax_nodes(_ctx) - nodes);
+        atomic_store(&task->owner, SH_DONE);
+    }
+    
+    return true;
+}
+
+Result Shared_solve(Shared* restrict _sh, NegamaxContext* restrict _ctx, Make7* restrict _m7, const int _PROCESSES, Result* restrict _r1, Result* restrict _r2, Result* restrict _r3, uint8_t* restrict _bestMove)
+{
+    SharedHeader *header = _sh->header;
+    struct timespec nap = { .tv_nsec = 10000000 };
+    pid_t worker[_PROCESSES], done;
+    int retries[_PROCESSES], count, pending, unfinished, running = 0, status, owner, w, i;
+    bool printed[MAKE7_SIZE_X3], mirror = Make7_symmetrical(_m7);
+    Result *tileResl;
+    
+    Shared_post(_sh, _m7);
+    count = atomic_load(&header->count);
+    
+    for (i = 0; i < count; i++)
+    {
+        printed[i] = (atomic_load(&header->task[i].owner) == SH_DONE);
+    }
+    
+    for (w = 0; w < _PROCESSES; w++)
+    {
+        worker[w] = -1;
+        retries[w] = 0;
+    }
+    
+    // Anything still buffered would be written again by every worker
+    fflush(stdout);
+    
+    for (;;)
+    {
+        // Workers that died hand their moves back; those that ran out of moves just leave
+        while ((done = waitpid(-1, &status, WNOHANG)) > 0)
+        {
+            for (w = 0; (w < _PROCESSES) && (worker[w] != done); w++);
+            
+            if (w == _PROCESSES)
+            {
+                continue;
+            }
+            
+            if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+            {
+                fprintf(stderr, "Worker #%d stopped unexpectedly.\n", w);
+                retries[w]++;
+            }
+            
+            worker[w] = -1;
+            running--;
+        }
+        
+        Shared_reclaim(_sh);
+        
+        // Print the results as the moves finish
+        for (i = pending = unfinished = 0; i < count; i++)
+        {
+            owner = atomic_load(&header->task[i].owner);
+            pending += (owner == SH_PENDING);
+            unfinished += (owner != SH_DONE);
+            
+            if ((owner == SH_DONE) && !printed[i])
+            {
+                printf("%d%c ", header->task[i].move >> 4, 'A' + (header->task[i].move & 0xf));
+                Result_print(&header->task[i].result, &header->task[i].result);
+                puts("");
+                
+                // The mirror image has the same result
+                if (mirror && ((header->task[i].move & 0xf) < (MAKE7_SIZE >> 1)))
+                {
+                    printf("%d%c ", header->task[i].move >> 4, 'A' + MAKE7_SIZE_M1 - (header->task[i].move & 0xf));
+                    Result_print(&header->task[i].result, &header->task[i].result);
+                    puts("");
+                }
+                
+                fflush(stdout);
+                printed[i] = true;
+            }
+        }
+        
+        if (!unfinished)
+        {
+            break;
+        }
+        
+        // Start a worker on every free slot while moves are waiting, unless the slot's workers keep dying
+        for (w = 0; pending && (w < _PROCESSES); w++)
+        {
+            if ((worker[w] < 0) && (retries[w] <= SH_RETRIES))
+            {
+                if (!(worker[w] = fork()))
+                {
+                    Numa_bind(w);
+                    _exit(Shared_work(_sh, _ctx, false) ? EXIT_SUCCESS : EXIT_FAILURE);
+                }
+                
+                running += (worker[w] > 0);
+                retries[w] += (worker[w] < 0) ? SH_RETRIES + 1 : 0;
+            }
+        }
+        
+        // Moves nobody is left to solve stay unknown
+        if (pending && !running)
+        {
+            fprintf(stderr, "Every worker stopped before the position was solved.\n");
+            break;
+        }
+        
+        thrd_sleep(&nap, nullptr);
+    }
+    
+    // Collect the results and the nodes it took by move
+    for (w = 0; w < MAKE7_SIZE; w++)
+    {
+        _r1[w] = _r2[w] = _r3[w] = RESULT_UNKNOWN;
+    }
+    
+    for (i = 0; i < count; i++)
+    {
+        tileResl = ((header->task[i].move >> 4) == 1) ? _r1 : ((header->task[i].move >> 4) == 2) ? _r2 : _r3;
+        tileResl[header->task[i].move & 0xf] = (atomic_load(&header->task[i].owner) == SH_DONE) ? header->task[i].result : RESULT_UNKNOWN;
+        atomic_fetch_add(&_ctx->counters[0].count, atomic_load(&header->task[i].nodes));
+    }
+    
+    // Copy the left half's results to the right half
+    for (w = 0; mirror && (w < (MAKE7_SIZE >> 1)); w++)
+    {
+        _r1[MAKE7_SIZE_M1 - w] = _r1[w];
+        _r2[MAKE7_SIZE_M1 - w] = _r2[w];
+        _r3[MAKE7_SIZE_M1 - w] = _r3[w];
+    }
+    
+    *_bestMove = Result_getBestMove(_r1, _r2, _r3);
+    
+    return Result_getBestResult(_r1, _r2, _r3);
+}
+#else
+// Without POSIX shared memory and fork, there are no processes to share a table with
+bool Shared_open(Shared* restrict _sh, const char* restrict _NAME, const size_t _SIZE, const bool _CREATE)
+{
+    (void)(_SIZE);
+    (void)(_CREATE);
+    _sh->header = nullptr;
+    _sh->table = (TransTable) { nullptr, 0 };
+    _sh->name = _NAME;
+    
+    return false;
+}
+
+void Shared_close(Shared* restrict _sh, const bool _REMOVE)
+{
+    (void)(_REMOVE);
+    _sh->header = nullptr;
+}
+
+int Shared_post(Shared* restrict _sh, const Make7* restrict _ROOT)
+{
+    (void)(_sh);
+    (void)(_ROOT);
+    
+    return 0;
+}
+
+bool Shared_claim(Shared* restrict _sh, int* restrict _task)
+{
+    (void)(_sh);
+    (void)(_task);
+    
+    return false;
+}
+
+int Shared_reclaim(Shared* restrict _sh)
+{
+    (void)(_sh);
+    
+    return 0;
+}
+
+bool Shared_work(Shared* restrict _sh, NegamaxContext* restrict _ctx, const bool _JOINED)
+{
+    (void)(_sh);
+    (void)(_ctx);
+    (void)(_JOINED);
+    
+    return false;
+}
+
+Result Shared_solve(Shared* restrict _sh, NegamaxContext* restrict _ctx, Make7* restrict _m7, const int _PROCESSES, Result* restrict _r1, Result* restrict _r2, Result* restrict _r3, uint8_t* restrict _bestMove)
+{
+    (void)(_sh);
+    (void)(_ctx);
+    (void)(_m7);
+    (void)(_PROCESSES);
+    (void)(_r1);
+    (void)(_r2);
+    (void)(_r3);
+    (void)(_bestMove);
+    
+    return RESULT_UNKNOWN;
+}
+#endif
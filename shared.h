@@ -0,0 +1,102 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    The shared table lets separate solver processes work on one position over a single transposition table in POSIX shared memory.
+    Threads are bound to one address space, and root parallelization splits the table between them; processes share all of it, and a crash only takes down one.
+    The segment holds a short header, a queue of the root moves of the position being solved, and the table itself, which starts at a page boundary.
+    
+    The solving process posts the root moves to the queue, and every worker claims one at a time by writing its process ID into the move's owner field.
+    A worker that dies leaves its ID behind; the solving process notices it is gone, hands the move back to the queue, and starts another worker in its place.
+    Table entries are stored with their keys XORed with their contents, so entries torn by two processes writing the same slot at once are harmless misses.
+    The table outlives its workers, and a segment of the same name and size left over by an earlier run is taken over with everything it already holds.
+    Other processes, for example ones bound to a NUMA node each, join in with --join and work the same queue until the solving process closes it.
+*/
+
+#ifndef SHARED_H
+#define SHARED_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifdef __unix__
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
+
+#include "make7.h"
+#include "table.h"
+#include "result.h"
+#include "negamax.h"
+#include "numa.h"
+
+#define SH_MAGIC "M7SH"
+#define SH_VERSION 1
+
+// The table starts this far into the segment
+#define SH_ALIGN 4096
+
+// The name of the segment when none is given
+#define SH_NAME "/make7"
+
+// How many times each worker that died is started again
+#define SH_RETRIES 3
+
+// Owners of a root move that is not being solved
+#define SH_PENDING 0
+#define SH_DONE -1
+
+// A root move in the queue
+typedef struct
+{
+    Make7 m7;                                                           // The position after the move
+    atomic_int owner;                                                   // The process solving it, or one of the above
+    atomic_ullong nodes;                                                // How many nodes it took
+    Result result;                                                      // Its result for the side to move at the root
+    uint8_t move;                                                       // The move itself
+}
+SharedTask;
+
+// The start of the segment
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t size;                                                      // Number of entries in the table
+    atomic_int count;                                                   // Number of root moves in the queue; zero while they are being posted
+    atomic_bool closed;                                                 // The solving process is done; workers that joined may leave
+    SharedTask task[MAKE7_SIZE_X3];
+}
+SharedHeader;
+
+// A process's view of the segment
+typedef struct
+{
+    SharedHeader *header;
+    TransTable table;
+    const char *name;
+    size_t bytes;
+}
+Shared;
+
+// Memory
+bool Shared_open(Shared*, const char*, const size_t, const bool);                                       // Create a segment with a table of a size, or attach to one
+void Shared_close(Shared*, const bool);                                                                 // Detach from it, removing it if asked to
+
+// The queue of root moves
+int Shared_post(Shared*, const Make7*);                                                                 // Queue the root moves of a position; the number left to solve
+bool Shared_claim(Shared*, int*);                                                                       // Take a root move nobody is solving; false if there is none
+int Shared_reclaim(Shared*);                                                                            // Hand the moves of processes that died back to the queue
+bool Shared_work(Shared*, NegamaxContext*, const bool);                                                 // Solve root moves until there are none left, or until closed
+
+// Solving
+Result Shared_solve(Shared*, NegamaxContext*, Make7*, const int, Result*, Result*, Result*, uint8_t*);  // Solve a position with worker processes over the segment
+
+#endif /* SHARED_H */
@@ -53,19 +53,14 @@ size_t TransTable_prevprime(size_t _n)
 
 bool TransTable_initialize(TransTable* restrict _tt, const size_t _INIT_SIZE)
 {
-    size_t entryAlloc;
     bool success = false;
     
     if (_INIT_SIZE > 3)
     {
         _tt->size = TransTable_prevprime(_INIT_SIZE);
-        entryAlloc = sizeof(*_tt->entry) * _tt->size;
         
-        if ((_tt->entry = malloc(entryAlloc)))
-        {
-            memset(_tt->entry, 0, entryAlloc);
-            success = true;
-        }
+        // Zeroed pages straight from the system are left untouched, so each lands on the node of the first thread to use it
+        success = (_tt->entry = calloc(_tt->size, sizeof(*_tt->entry)));
     }
     
     return success;
@@ -77,19 +72,80 @@ void TransTable_destroy(TransTable* restrict _tt)
     _tt->entry = NULL;
 }
 
-void TransTable_store(TransTable* restrict _tt, const uint64_t _G_KEY, const uint64_t _KEY2, const uint64_t _KEY3, const int _VAL)
+void TransTable_store(TransTable* restrict _tt, const uint64_t _G_KEY, const uint64_t _KEY2, const uint64_t _KEY3, const int _VAL, const uint8_t _DEPTH)
 {
     size_t i = _G_KEY % _tt->size;
+    uint64_t data = (uint32_t)(_VAL) | ((uint64_t)(_DEPTH) << 32);
     
-    _tt->entry[i].gridKey = _G_KEY;
-    _tt->entry[i].twoKey = _KEY2;
-    _tt->entry[i].threeKey = _KEY3;
+    _tt->entry[i].gridKey = _G_KEY ^ data;
+    _tt->entry[i].twoKey = _KEY2 ^ data;
+    _tt->entry[i].threeKey = _KEY3 ^ data;
     _tt->entry[i].value = _VAL;
+    _tt->entry[i].depth = _DEPTH;
 }
 
-int TransTable_load(TransTable* restrict _tt, const uint64_t _G_KEY, const uint64_t _KEY2, const uint64_t _KEY3)
+int TransTable_load(TransTable* restrict _tt, const uint64_t _G_KEY, const uint64_t _KEY2, const uint64_t _KEY3, const uint8_t _DEPTH)
 {
     size_t i = _G_KEY % _tt->size;
+    TT_Entry probe = _tt->entry[i];
+    uint64_t data = (uint32_t)(probe.value) | ((uint64_t)(probe.depth) << 32);
+    
+    // Only trust results proven within the depth we have left to search
+    return ((probe.gridKey ^ data) == _G_KEY) && ((probe.twoKey ^ data) == _KEY2) && ((probe.threeKey ^ data) == _KEY3) && (probe.depth <= _DEPTH) ? probe.value : TT_UNKNOWN;
+}
+
+// Tiles of different numbers on the same squares share a grid key, so fold the other two keys into the slot too; proof-number search visits such siblings back to back
+static inline size_t ProofTable_index(const ProofTable* restrict _PT, const uint64_t _G_KEY, const uint64_t _KEY2, const uint64_t _KEY3)
+{
+    return (_G_KEY ^ (_KEY2 * 0x9e3779b97f4a7c15ull) ^ (_KEY3 * 0xc2b2ae3d27d4eb4full)) % _PT->size;
+}
+
+bool ProofTable_initialize(ProofTable* restrict _pt, const size_t _INIT_SIZE)
+{
+    bool success = false;
+    
+    if (_INIT_SIZE > 3)
+    {
+        _pt->size = TransTable_prevprime(_INIT_SIZE);
+        success = (_pt->entry = calloc(_pt->size, sizeof(*_pt->entry)));
+    }
+    
+    return success;
+}
+
+void ProofTable_destroy(ProofTable* restrict _pt)
+{
+    free(_pt->entry);
+    _pt->entry = NULL;
+}
+
+void ProofTable_store(ProofTable* restrict _pt, const uint64_t _G_KEY, const uint64_t _KEY2, const uint64_t _KEY3, const uint32_t _PROOF, const uint32_t _DISPROOF, const uint8_t _DEPTH)
+{
+    size_t i = ProofTable_index(_pt, _G_KEY, _KEY2, _KEY3);
+    uint64_t data = _PROOF | ((uint64_t)(_DISPROOF) << 32);
+    
+    _pt->entry[i].gridKey = _G_KEY ^ data;
+    _pt->entry[i].twoKey = _KEY2 ^ data;
+    _pt->entry[i].threeKey = _KEY3 ^ data ^ _DEPTH;
+    _pt->entry[i].proof = _PROOF;
+    _pt->entry[i].disproof = _DISPROOF;
+    _pt->entry[i].depth = _DEPTH;
+}
+
+bool ProofTable_load(ProofTable* restrict _pt, const uint64_t _G_KEY, const uint64_t _KEY2, const uint64_t _KEY3, uint32_t* restrict _proof, uint32_t* restrict _disproof, uint8_t* restrict _depth)
+{
+    size_t i = ProofTable_index(_pt, _G_KEY, _KEY2, _KEY3);
+    PT_Entry probe = _pt->entry[i];
+    uint64_t data = probe.proof | ((uint64_t)(probe.disproof) << 32);
+    
+    if (((probe.gridKey ^ data) != _G_KEY) || ((probe.twoKey ^ data) != _KEY2) || ((probe.threeKey ^ data ^ probe.depth) != _KEY3))
+    {
+        return false;
+    }
     
-    return (_tt->entry[i].gridKey == _G_KEY) && (_tt->entry[i].twoKey == _KEY2) && (_tt->entry[i].threeKey == _KEY3) ? _tt->entry[i].value : TT_UNKNOWN;
+    *_proof = probe.proof;
+    *_disproof = probe.disproof;
+    *_depth = probe.depth;
+    
+    return true;
 }
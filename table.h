@@ -4,6 +4,14 @@
     Transposition tables are hash tables that store intermediate results of depth-first search algorithms.
     To minimize the number of collisions, the table size is the largest prime number less than the initial size.
     It does not handle collisions; it will always overwrite the previous entry, given the same key and different value.
+    
+    Every entry also records the remaining search depth it was proven at, and a probe only accepts entries whose depth does not exceed the depth being searched.
+    A win or loss found within fewer plies still holds at any greater depth, but not the other way around, so depth-to-7 results stay exact when the table is shared.
+    
+    The keys are stored XORed with the value and depth to make the table safe to share between threads without locks.
+    If two threads write the same slot at once and the entry gets torn, the keys will not match on the next probe, turning it into a harmless miss.
+    
+    The proof-number table is laid out the same way for proof-number search, but holds a proof number, a disproof number, and the length of the proof instead.
 */
 
 #ifndef TABLE_H
@@ -22,6 +30,7 @@ typedef struct
 {
     uint64_t gridKey, twoKey, threeKey;
     int value;
+    uint8_t depth;
 }
 TT_Entry;
 
@@ -33,6 +42,23 @@ typedef struct
 }
 TransTable;
 
+// A single entry to the proof-number table
+typedef struct
+{
+    uint64_t gridKey, twoKey, threeKey;
+    uint32_t proof, disproof;
+    uint8_t depth;
+}
+PT_Entry;
+
+// The proof-number table itself
+typedef struct
+{
+    PT_Entry *entry;
+    size_t size;
+}
+ProofTable;
+
 // Prime number testing algorithms to minimize hash collisions
 bool TransTable_prime(const size_t);                                                                    // Tests if a number is prime
 size_t TransTable_prevprime(size_t);                                                                    // Finds the largest prime number less than the input
@@ -42,7 +68,13 @@ bool TransTable_initialize(TransTable*, const size_t);
 void TransTable_destroy(TransTable*);                                                                   // Release the memory allocated to it   
 
 // Operations on transposition tables
-void TransTable_store(TransTable*, const uint64_t, const uint64_t, const uint64_t, const int);          // Stores a key-value pair into the table
-int TransTable_load(TransTable*, const uint64_t, const uint64_t, const uint64_t);                       // Loads a value from the table given a key
+void TransTable_store(TransTable*, const uint64_t, const uint64_t, const uint64_t, const int, const uint8_t);   // Stores a key-value pair into the table
+int TransTable_load(TransTable*, const uint64_t, const uint64_t, const uint64_t, const uint8_t);              // Loads a value from the table given a key
+
+// Memory allocation and operations on proof-number tables
+bool ProofTable_initialize(ProofTable*, const size_t);                                                  // Initializes the proof-number table
+void ProofTable_destroy(ProofTable*);                                                                   // Release the memory allocated to it
+void ProofTable_store(ProofTable*, const uint64_t, const uint64_t, const uint64_t, const uint32_t, const uint32_t, const uint8_t);   // Stores the proof and disproof numbers of a key
+bool ProofTable_load(ProofTable*, const uint64_t, const uint64_t, const uint64_t, uint32_t*, uint32_t*, uint8_t*);                  // Loads them given a key; false if absent
 
 #endif /* TABLE_H */
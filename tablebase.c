@@ -0,0 +1,372 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+*/
+
+#include "tablebase.h"
+
+uint64_t Tablebase_mirror(const uint64_t _KEY)
+{
+    // The grid key can fill a column up to its guard bit, which Make7_reverse drops; reversing whole bytes keeps it
+    return __builtin_bswap64(_KEY) >> 8;
+}
+
+TB_Key Tablebase_key(const Make7* restrict _M7)
+{
+    TB_Key key = { Make7_hashEncode(_M7), _M7->tiles23[0], _M7->tiles23[1] };
+    TB_Key mirror = { Tablebase_mirror(key.gridKey), Tablebase_mirror(key.twoKey), Tablebase_mirror(key.threeKey) };
+    
+    return (Tablebase_compare(&mirror, &key) < 0) ? mirror : key;
+}
+
+int Tablebase_compare(const void *_A, const void *_B)
+{
+    // A layer's positions start with their keys, so the same comparison sorts them too
+    const TB_Key *a = _A, *b = _B;
+    
+    if (a->gridKey != b->gridKey)
+    {
+        return (a->gridKey < b->gridKey) ? -1 : 1;
+    }
+    
+    if (a->twoKey != b->twoKey)
+    {
+        return (a->twoKey < b->twoKey) ? -1 : 1;
+    }
+    
+    return (a->threeKey < b->threeKey) ? -1 : (a->threeKey > b->threeKey);
+}
+
+uint8_t Tablebase_encode(const Result _RESULT)
+{
+    switch (_RESULT.wdl)
+    {
+        case WIN_CHAR:
+            return TB_WIN | _RESULT.dt7;
+        case LOSS_CHAR:
+            return TB_LOSS | _RESULT.dt7;
+        case DRAW_CHAR:
+            return TB_DRAW;
+        default:
+            return TB_UNKNOWN;
+    }
+}
+
+Result Tablebase_decode(const uint8_t _VALUE)
+{
+    switch (_VALUE & ~TB_DT7)
+    {
+        case TB_WIN:
+            return (Result) { WIN_CHAR, _VALUE & TB_DT7 };
+        case TB_LOSS:
+            return (Result) { LOSS_CHAR, _VALUE & TB_DT7 };
+        case TB_DRAW:
+            return RESULT_DRAW;
+        default:
+            return RESULT_UNKNOWN;
+    }
+}
+
+void Tablebase_destroy(Tablebase* restrict _tb)
+{
+    free(_tb->key);
+    free(_tb->value);
+    _tb->key = nullptr;
+    _tb->value = nullptr;
+    _tb->count = 0;
+}
+
+bool Tablebase_save(const Tablebase* restrict _TB, const char* restrict _PATH)
+{
+    FILE *file = fopen(_PATH, "wb");
+    uint32_t version = TB_VERSION;
+    uint64_t count = _TB->count;
+    bool written;
+    
+    if (!file)
+    {
+        return false;
+    }
+    
+    written = (fwrite(TB_MAGIC, 4, 1, file) == 1) && (fwrite(&version, sizeof(version), 1, file) == 1) && (fwrite(&_TB->minPly, 1, 1, file) == 1) && (fwrite(&_TB->maxPly, 1, 1, file) == 1) && (fwrite(&count, sizeof(count), 1, file) == 1)
+        && (fwrite(_TB->key, sizeof(*_TB->key), _TB->count, file) == _TB->count) && (fwrite(_TB->value, 1, _TB->count, file) == _TB->count);
+    
+    return !fclose(file) && written;
+}
+
+bool Tablebase_load(Tablebase* restrict _tb, const char* restrict _PATH)
+{
+    FILE *file = fopen(_PATH, "rb");
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+    bool read;
+    
+    _tb->key = nullptr;
+    _tb->value = nullptr;
+    _tb->count = 0;
+    
+    if (!file)
+    {
+        return false;
+    }
+    
+    // Refuse files that are not tablebases, or of another version
+    if ((fread(magic, 4, 1, file) != 1) || memcmp(magic, TB_MAGIC, 4) || (fread(&version, sizeof(version), 1, file) != 1) || (version != TB_VERSION)
+        || (fread(&_tb->minPly, 1, 1, file) != 1) || (fread(&_tb->maxPly, 1, 1, file) != 1) || (fread(&count, sizeof(count), 1, file) != 1))
+    {
+        fclose(file);
+        return false;
+    }
+    
+    if (!(_tb->key = malloc(count * sizeof(*_tb->key))) || !(_tb->value = malloc(count)))
+    {
+        fclose(file);
+        Tablebase_destroy(_tb);
+        return false;
+    }
+    
+    _tb->count = count;
+    read = (fread(_tb->key, sizeof(*_tb->key), count, file) == count) && (fread(_tb->value, 1, count, file) == count);
+    fclose(file);
+    
+    if (!read)
+    {
+        Tablebase_destroy(_tb);
+    }
+    
+    return read;
+}
+
+bool Tablebase_probe(const Tablebase* restrict _TB, const Make7* restrict _M7, Result* restrict _result)
+{
+    uint8_t ply = Make7_plyNum(_M7);
+    
+    // Most positions a search visits are outside of its plies, and the ply count is much cheaper than the keys
+    if ((ply < _TB->minPly) || (ply > _TB->maxPly))
+    {
+        return false;
+    }
+    
+    TB_Key key = Tablebase_key(_M7);
+    TB_Key *found = bsearch(&key, _TB->key, _TB->count, sizeof(*_TB->key), Tablebase_compare);
+    
+    if (!found)
+    {
+        return false;
+    }
+    
+    *_result = Tablebase_decode(_TB->value[found - _TB->key]);
+    
+    return true;
+}
+
+size_t Tablebase_expand(const TB_Position* restrict _LAYER, const size_t _COUNT, TB_Position** restrict _next)
+{
+    uint8_t list[MAKE7_SIZE_X3], total;
+    size_t capacity = _COUNT * MAKE7_SIZE_X3, count = 0, unique = 0;
+    
+    if (!(*_next = malloc((capacity ? capacity : 1) * sizeof(**_next))))
+    {
+        return SIZE_MAX;
+    }
+    
+    // Positions that already ended have no children
+    for (size_t pos = 0; pos < _COUNT; pos++)
+    {
+        if (Make7_checkFor7(&_LAYER[pos].m7) || Make7_noMoreMoves(&_LAYER[pos].m7))
+        {
+            continue;
+        }
+        
+        Make7_generate(&_LAYER[pos].m7, list, &total);
+        
+        for (uint8_t mv = 0; mv < total; mv++)
+        {
+            (*_next)[count].m7 = _LAYER[pos].m7;
+            Make7_drop(&(*_next)[count].m7, list[mv] >> 4, list[mv] & 0xf);
+            (*_next)[count].key = Tablebase_key(&(*_next)[count].m7);
+            (*_next)[count++].value = TB_DRAW;
+        }
+    }
+    
+    // Transpositions and mirror images end up next to each other, so only the first of every run is kept
+    qsort(*_next, count, sizeof(**_next), Tablebase_compare);
+    
+    for (size_t pos = 0; pos < count; pos++)
+    {
+        if (!unique || Tablebase_compare(&(*_next)[unique - 1].key, &(*_next)[pos].key))
+        {
+            (*_next)[unique++] = (*_next)[pos];
+        }
+    }
+    
+    return unique;
+}
+
+int Tablebase_solveWorker(void *_args)
+{
+    TablebaseArgs *args = _args;
+    NegamaxThread worker;
+    
+    // Every worker searches the shared table, so what one proves the others reuse
+    NegamaxThread_initialize(&worker, args->ctx, &args->ctx->table, 0);
+    
+    for (size_t pos = args->begin; pos < args->end; pos++)
+    {
+        Make7 m7 = args->layer[pos].m7;
+        
+        args->layer[pos].value = Tablebase_encode(Negamax_solve(&worker, &m7, false));
+    }
+    
+    return 0;
+}
+
+int Tablebase_backupWorker(void *_args)
+{
+    TablebaseArgs *args = _args;
+    uint8_t list[MAKE7_SIZE_X3], total, winDepth, lossDepth;
+    bool draw, unknown;
+    
+    for (size_t pos = args->begin; pos < args->end; pos++)
+    {
+        const Make7 *m7 = &args->layer[pos].m7;
+        
+        if (Make7_checkFor7(m7))
+        {
+            args->layer[pos].value = TB_WIN;
+            continue;
+        }
+        
+        if (Make7_noMoreMoves(m7))
+        {
+            args->layer[pos].value = TB_DRAW;
+            continue;
+        }
+        
+        // A child lost by its mover is a win for us, the shortest one counting; failing that, a draw; failing that, the longest loss
+        // A child left unsolved leaves the position unsolved too, unless another child already wins
+        winDepth = UINT8_MAX;
+        lossDepth = 0;
+        draw = unknown = false;
+        Make7_generate(m7, list, &total);
+        
+        for (uint8_t mv = 0; mv < total; mv++)
+        {
+            TB_Position child = { .m7 = *m7 };
+            TB_Position *found;
+            
+            Make7_drop(&child.m7, list[mv] >> 4, list[mv] & 0xf);
+            child.key = Tablebase_key(&child.m7);
+            found = bsearch(&child, args->below, args->belowCount, sizeof(*args->below), Tablebase_compare);
+            
+            switch (found->value & ~TB_DT7)
+            {
+                case TB_LOSS:
+                    winDepth = ((found->value & TB_DT7) < winDepth) ? (found->value & TB_DT7) : winDepth;
+                    break;
+                case TB_WIN:
+                    lossDepth = ((found->value & TB_DT7) > lossDepth) ? (found->value & TB_DT7) : lossDepth;
+                    break;
+                case TB_UNKNOWN:
+                    unknown = true;
+                    break;
+                default:
+                    draw = true;
+            }
+        }
+        
+        args->layer[pos].value = (winDepth != UINT8_MAX) ? (TB_WIN | (winDepth + 1)) : (unknown ? TB_UNKNOWN : (draw ? TB_DRAW : (TB_LOSS | (lossDepth + 1))));
+    }
+    
+    return 0;
+}
+
+bool Tablebase_generate(Tablebase* restrict _tb, NegamaxContext* restrict _ctx, const Make7* restrict _ROOT, const uint8_t _PLIES, const bool _VERBOSE)
+{
+    TB_Position **layer = calloc(_PLIES + 1, sizeof(*layer)), *merged = nullptr;
+    size_t *count = calloc(_PLIES + 1, sizeof(*count));
+    TablebaseArgs *args = nullptr;
+    size_t tasks, total = 0;
+    bool success = layer && count && (layer[0] = malloc(sizeof(**layer)));
+    
+    _tb->key = nullptr;
+    _tb->value = nullptr;
+    _tb->count = 0;
+    _tb->minPly = Make7_plyNum(_ROOT);
+    _tb->maxPly = _tb->minPly + _PLIES;
+    
+    if (success)
+    {
+        layer[0]->m7 = *_ROOT;
+        layer[0]->key = Tablebase_key(_ROOT);
+        count[0] = 1;
+    }
+    
+    // Enumerate every position reachable from the root, one ply at a time
+    for (uint8_t ply = 1; success && (ply <= _PLIES); ply++)
+    {
+        if ((success = ((count[ply] = Tablebase_expand(layer[ply - 1], count[ply - 1], &layer[ply])) != SIZE_MAX)) && _VERBOSE)
+        {
+            printf("Ply %u: %llu positions\n", _tb->minPly + ply, (unsigned long long)count[ply]);
+        }
+    }
+    
+    // Tasks of a fixed number of positions each keep the workers evenly busy however long the solves take; no layer is larger than the deepest
+    success = success && (args = malloc((count[_PLIES] / TB_CHUNK + 1) * sizeof(*args)));
+    
+    // The deepest layer has no children to go by, so it is searched; every layer above only looks its children up
+    for (int ply = _PLIES; success && (ply >= 0); ply--)
+    {
+        tasks = 0;
+        
+        for (size_t begin = 0; begin < count[ply]; begin += TB_CHUNK, tasks++)
+        {
+            args[tasks] = (TablebaseArgs) { _ctx, layer[ply], (ply < _PLIES) ? layer[ply + 1] : nullptr, begin, (begin + TB_CHUNK < count[ply]) ? begin + TB_CHUNK : count[ply], (ply < _PLIES) ? count[ply + 1] : 0 };
+            ThreadPool_submit(_ctx->pool, (ply < _PLIES) ? Tablebase_backupWorker : Tablebase_solveWorker, &args[tasks]);
+        }
+        
+        ThreadPool_wait(_ctx->pool);
+        total += count[ply];
+        
+        if (_VERBOSE)
+        {
+            printf("Ply %u solved\n", _tb->minPly + ply);
+        }
+    }
+    
+    // Every layer holds a different number of tiles, so their keys never collide when merged into one sorted list
+    if ((success = success && (merged = malloc(total * sizeof(*merged))) && (_tb->key = malloc(total * sizeof(*_tb->key))) && (_tb->value = malloc(total))))
+    {
+        for (size_t ply = 0, at = 0; ply <= _PLIES; at += count[ply++])
+        {
+            memcpy(&merged[at], layer[ply], count[ply] * sizeof(*merged));
+        }
+        
+        qsort(merged, total, sizeof(*merged), Tablebase_compare);
+        
+        for (size_t pos = 0; pos < total; pos++)
+        {
+            _tb->key[pos] = merged[pos].key;
+            _tb->value[pos] = merged[pos].value;
+        }
+        
+        _tb->count = total;
+    }
+    
+    for (int ply = 0; layer && (ply <= _PLIES); ply++)
+    {
+        free(layer[ply]);
+    }
+    
+    free(layer);
+    free(count);
+    free(args);
+    free(merged);
+    
+    if (!success)
+    {
+        Tablebase_destroy(_tb);
+    }
+    
+    return success;
+}
@@ -0,0 +1,91 @@
+/*
+    Copyright (C) 2020- TheTrustedComputer
+    
+    An endgame tablebase holds the exact result of every position in a subtree of the game, from a root position down to a number of plies below it.
+    It is generated retrograde: the deepest layer is solved by negamax, split between the pool workers, and every layer above takes its results from its children in the layer below without searching at all.
+    Mirror images score the same, so a position is stored under whichever of its keys and those of its mirror image sort first.
+    
+    The file holds the keys of every position in sorted order, then one byte per position with its result; the rank of a position's keys is the index of its result.
+    Negamax probes it at every node within its plies as a leaf oracle, and Monte Carlo tree search playouts stop as soon as they reach a position in it.
+*/
+
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "make7.h"
+#include "result.h"
+#include "pool.h"
+#include "negamax.h"
+
+#define TB_MAGIC "M7TB"
+#define TB_VERSION 1
+
+// Number of positions in a single generation task
+#define TB_CHUNK 64
+
+// Result encoding; the distance to 7 takes the low six bits
+#define TB_DRAW 0x00
+#define TB_WIN 0x40
+#define TB_LOSS 0x80
+#define TB_UNKNOWN 0xc0
+#define TB_DT7 0x3f
+
+// The keys of a position; the same three the transposition table uses
+typedef struct
+{
+    uint64_t gridKey, twoKey, threeKey;
+}
+TB_Key;
+
+// A position of the layer being generated
+typedef struct
+{
+    TB_Key key;
+    Make7 m7;
+    uint8_t value;
+}
+TB_Position;
+
+// The tablebase itself
+typedef struct Tablebase
+{
+    TB_Key *key;
+    uint8_t *value;
+    size_t count;
+    uint8_t minPly, maxPly;
+}
+Tablebase;
+
+// Generation task's parameters
+typedef struct
+{
+    NegamaxContext *ctx;
+    TB_Position *layer, *below;
+    size_t begin, end, belowCount;
+}
+TablebaseArgs;
+
+// Keys and results
+uint64_t Tablebase_mirror(const uint64_t);                                                              // Flip a key horizontally; every column is a byte
+TB_Key Tablebase_key(const Make7*);                                                                     // The keys a position is stored under
+int Tablebase_compare(const void*, const void*);                                                        // Order keys for sorting and searching
+uint8_t Tablebase_encode(const Result);                                                                 // Pack a result into a byte
+Result Tablebase_decode(const uint8_t);                                                                 // Unpack it
+
+// Memory and I/O
+void Tablebase_destroy(Tablebase*);                                                                     // Release the memory allocated to it
+bool Tablebase_save(const Tablebase*, const char*);                                                     // Write it to a file
+bool Tablebase_load(Tablebase*, const char*);                                                           // Read it from a file
+bool Tablebase_probe(const Tablebase*, const Make7*, Result*);                                          // Look up the result of a position; false if not in it
+
+// Generation
+size_t Tablebase_expand(const TB_Position*, const size_t, TB_Position**);                               // Collect the distinct children of a layer, in key order
+int Tablebase_solveWorker(void*);                                                                       // Solve part of the deepest layer with negamax
+int Tablebase_backupWorker(void*);                                                                      // Take part of a layer's results from the layer below
+bool Tablebase_generate(Tablebase*, NegamaxContext*, const Make7*, const uint8_t, const bool);          // Generate the tablebase of a root position to a number of plies
+
+#endif /* TABLEBASE_H */